@@ -3,11 +3,19 @@
 #include <string.h>   // Para manipulação de strings (strcpy, strcmp)
 #include <stdbool.h>  // Para usar tipos booleanos (true/false)
 
+// O modo servidor é opcional: compile com -DCOM_SERVIDOR e junto com servidor.c para ativá-lo
+// (ex.: gcc -DCOM_SERVIDOR -pthread Exercicio1.c servidor.c). Sem isso, só este arquivo basta.
+#ifdef COM_SERVIDOR
+#include "servidor.h" // Para o modo servidor concorrente
+#endif
+
 // Definições e Estruturas
 
 #define MAX_USUARIOS 100 // Número máximo de usuários na rede
 #define NOME_MAX 50      // Tamanho máximo do nome do usuário
 
+#define SOCKET_PADRAO "/tmp/rede_social.sock" // Caminho padrão do socket do servidor
+
 // Estrutura para representar um usuário
 typedef struct Usuario {
     int id;          // ID único do usuário (índice no array de usuários)
@@ -63,6 +71,21 @@ void liberarGrafo(Grafo* g) {
     }
 }
 
+// Copia o grafo 'origem' para 'destino', duplicando as listas de adjacência
+// (a ordem das listas é mantida, então as buscas visitam os amigos na mesma ordem)
+void copiarGrafo(Grafo* destino, const Grafo* origem) {
+    inicializarGrafo(destino);
+    destino->num_usuarios = origem->num_usuarios;
+    for (int i = 0; i < origem->num_usuarios; i++) {
+        destino->usuarios[i] = origem->usuarios[i];
+        NoAdj** fim = &destino->adj[i]; // Onde o próximo nó copiado será pendurado
+        for (NoAdj* atual = origem->adj[i]; atual != NULL; atual = atual->prox) {
+            *fim = criarNoAdj(atual->id_amigo);
+            fim = &(*fim)->prox;
+        }
+    }
+}
+
 // Encontra o ID de um usuário pelo nome
 int obterIdUsuarioPorNome(Grafo* g, const char* nome) {
     for (int i = 0; i < g->num_usuarios; i++) {
@@ -76,14 +99,15 @@ int obterIdUsuarioPorNome(Grafo* g, const char* nome) {
 // Funções do Grafo (Nossa Rede Social) 
 
 // Adiciona um novo usuário ao grafo
-void adicionarUsuario(Grafo* g, const char* nome) {
+// Retorna true se o usuário foi adicionado
+bool adicionarUsuario(Grafo* g, const char* nome, FILE* saida) {
     if (g->num_usuarios >= MAX_USUARIOS) {
-        printf("Limite de usuarios atingido.\n");
-        return;
+        fprintf(saida, "Limite de usuarios atingido.\n");
+        return false;
     }
     if (obterIdUsuarioPorNome(g, nome) != -1) {
-        printf("Usuario '%s' ja existe.\n", nome);
-        return;
+        fprintf(saida, "Usuario '%s' ja existe.\n", nome);
+        return false;
     }
 
     // Encontra o próximo ID disponível
@@ -92,20 +116,28 @@ void adicionarUsuario(Grafo* g, const char* nome) {
     strcpy(g->usuarios[novo_id].nome, nome); // Copia o nome
     g->adj[novo_id] = NULL;                  // Inicializa a lista de adjacência vazia
     g->num_usuarios++;                       // Incrementa o contador de usuários
-    printf("Usuario '%s' adicionado com sucesso! (ID: %d)\n", nome, novo_id);
+    fprintf(saida, "Usuario '%s' adicionado com sucesso! (ID: %d)\n", nome, novo_id);
+    return true;
 }
 
 // Cria uma conexão (amizade) entre dois usuários
-void criarConexao(Grafo* g, int id1, int id2) {
+// Retorna true se a conexão foi criada
+bool criarConexao(Grafo* g, int id1, int id2, FILE* saida) {
     // Verifica se os IDs são válidos
     if (id1 < 0 || id1 >= g->num_usuarios || g->usuarios[id1].id == -1 ||
         id2 < 0 || id2 >= g->num_usuarios || g->usuarios[id2].id == -1) {
-        printf("IDs de usuario invalidos para criar conexao.\n");
-        return;
+        fprintf(saida, "IDs de usuario invalidos para criar conexao.\n");
+        return false;
     }
     if (id1 == id2) {
-        printf("Um usuario nao pode ser amigo de si mesmo.\n");
-        return;
+        fprintf(saida, "Um usuario nao pode ser amigo de si mesmo.\n");
+        return false;
+    }
+    for (NoAdj* atual = g->adj[id1]; atual != NULL; atual = atual->prox) {
+        if (atual->id_amigo == id2) {
+            fprintf(saida, "'%s' e '%s' ja sao amigos.\n", g->usuarios[id1].nome, g->usuarios[id2].nome);
+            return false;
+        }
     }
 
     // Adiciona id2 na lista de adjacência de id1
@@ -118,24 +150,25 @@ void criarConexao(Grafo* g, int id1, int id2) {
     novoNo2->prox = g->adj[id2];
     g->adj[id2] = novoNo2;
 
-    printf("Conexao entre '%s' e '%s' criada com sucesso!\n", g->usuarios[id1].nome, g->usuarios[id2].nome);
+    fprintf(saida, "Conexao entre '%s' e '%s' criada com sucesso!\n", g->usuarios[id1].nome, g->usuarios[id2].nome);
+    return true;
 }
 
 // Exibe os amigos diretos de um usuário
-void visualizarAmizades(Grafo* g, int id_usuario) {
+void visualizarAmizades(Grafo* g, int id_usuario, FILE* saida) {
     if (id_usuario < 0 || id_usuario >= g->num_usuarios || g->usuarios[id_usuario].id == -1) {
-        printf("Usuario nao encontrado.\n");
+        fprintf(saida, "Usuario nao encontrado.\n");
         return;
     }
 
-    printf("Amigos de '%s':\n", g->usuarios[id_usuario].nome);
+    fprintf(saida, "Amigos de '%s':\n", g->usuarios[id_usuario].nome);
     NoAdj* atual = g->adj[id_usuario];
     if (atual == NULL) {
-        printf("  Nenhum amigo.\n");
+        fprintf(saida, "  Nenhum amigo.\n");
         return;
     }
     while (atual != NULL) {
-        printf("  - %s (ID: %d)\n", g->usuarios[atual->id_amigo].nome, atual->id_amigo);
+        fprintf(saida, "  - %s (ID: %d)\n", g->usuarios[atual->id_amigo].nome, atual->id_amigo);
         atual = atual->prox;
     }
 }
@@ -143,9 +176,9 @@ void visualizarAmizades(Grafo* g, int id_usuario) {
 // Algoritmos de Busca
 
 // Implementação da Busca em Largura (BFS)
-void bfs(Grafo* g, int inicio_id) {
+void bfs(Grafo* g, int inicio_id, FILE* saida) {
     if (inicio_id < 0 || inicio_id >= g->num_usuarios || g->usuarios[inicio_id].id == -1) {
-        printf("Usuario de inicio nao encontrado para BFS.\n");
+        fprintf(saida, "Usuario de inicio nao encontrado para BFS.\n");
         return;
     }
 
@@ -165,12 +198,12 @@ void bfs(Grafo* g, int inicio_id) {
     fila[tras++] = inicio_id;
     visitado[inicio_id] = true;
 
-    printf("\n--- Busca em Largura (BFS) a partir de '%s' ---\n", g->usuarios[inicio_id].nome);
+    fprintf(saida, "\n--- Busca em Largura (BFS) a partir de '%s' ---\n", g->usuarios[inicio_id].nome);
 
     // Enquanto a fila não estiver vazia
     while (frente < tras) {
         int u_id = fila[frente++]; // Pega o primeiro da fila
-        printf("Visitando: %s (ID: %d)\n", g->usuarios[u_id].nome, u_id);
+        fprintf(saida, "Visitando: %s (ID: %d)\n", g->usuarios[u_id].nome, u_id);
 
         // Percorre os amigos do usuário atual
         NoAdj* atual = g->adj[u_id];
@@ -184,13 +217,13 @@ void bfs(Grafo* g, int inicio_id) {
             atual = atual->prox;
         }
     }
-    printf("--- Fim do BFS ---\n");
+    fprintf(saida, "--- Fim do BFS ---\n");
 }
 
 // Função auxiliar recursiva para a Busca em Profundidade (DFS)
-void dfs_recursivo(Grafo* g, int u_id, bool visitado[]) {
+void dfs_recursivo(Grafo* g, int u_id, bool visitado[], FILE* saida) {
     visitado[u_id] = true; // Marca o usuário atual como visitado
-    printf("Visitando: %s (ID: %d)\n", g->usuarios[u_id].nome, u_id);
+    fprintf(saida, "Visitando: %s (ID: %d)\n", g->usuarios[u_id].nome, u_id);
 
     // Percorre os amigos do usuário atual
     NoAdj* atual = g->adj[u_id];
@@ -198,16 +231,16 @@ void dfs_recursivo(Grafo* g, int u_id, bool visitado[]) {
         int v_id = atual->id_amigo;
         // Se o amigo não foi visitado, chama o DFS para ele
         if (!visitado[v_id]) {
-            dfs_recursivo(g, v_id, visitado);
+            dfs_recursivo(g, v_id, visitado, saida);
         }
         atual = atual->prox;
     }
 }
 
 // Implementação da Busca em Profundidade (DFS)
-void dfs(Grafo* g, int inicio_id) {
+void dfs(Grafo* g, int inicio_id, FILE* saida) {
     if (inicio_id < 0 || inicio_id >= g->num_usuarios || g->usuarios[inicio_id].id == -1) {
-        printf("Usuario de inicio nao encontrado para DFS.\n");
+        fprintf(saida, "Usuario de inicio nao encontrado para DFS.\n");
         return;
     }
 
@@ -217,17 +250,17 @@ void dfs(Grafo* g, int inicio_id) {
         visitado[i] = false; // Ninguém foi visitado ainda
     }
 
-    printf("\n--- Busca em Profundidade (DFS) a partir de '%s' ---\n", g->usuarios[inicio_id].nome);
-    dfs_recursivo(g, inicio_id, visitado); // Chama a função recursiva
-    printf("--- Fim do DFS ---\n");
+    fprintf(saida, "\n--- Busca em Profundidade (DFS) a partir de '%s' ---\n", g->usuarios[inicio_id].nome);
+    dfs_recursivo(g, inicio_id, visitado, saida); // Chama a função recursiva
+    fprintf(saida, "--- Fim do DFS ---\n");
 }
 
 // --- Funcionalidades da Rede Social ---
 
 // Sugere amigos baseando-se em amigos de amigos (conexões de segundo grau)
-void sugerirAmigos(Grafo* g, int id_usuario) {
+void sugerirAmigos(Grafo* g, int id_usuario, FILE* saida) {
     if (id_usuario < 0 || id_usuario >= g->num_usuarios || g->usuarios[id_usuario].id == -1) {
-        printf("Usuario nao encontrado para sugestao de amigos.\n");
+        fprintf(saida, "Usuario nao encontrado para sugestao de amigos.\n");
         return;
     }
 
@@ -264,28 +297,187 @@ void sugerirAmigos(Grafo* g, int id_usuario) {
         }
     }
 
-    printf("\n--- Sugestoes de Amigos para '%s' ---\n", g->usuarios[id_usuario].nome);
+    fprintf(saida, "\n--- Sugestoes de Amigos para '%s' ---\n", g->usuarios[id_usuario].nome);
     bool encontrou_sugestao = false;
 
     // Percorre todos os usuários para encontrar sugestões
     for (int i = 0; i < g->num_usuarios; i++) {
         // Se o usuário está a distância 2 (amigo de amigo) e não é o próprio usuário
         if (distancia[i] == 2) {
-            printf("  - %s (ID: %d)\n", g->usuarios[i].nome, i);
+            fprintf(saida, "  - %s (ID: %d)\n", g->usuarios[i].nome, i);
             encontrou_sugestao = true;
         }
     }
 
     if (!encontrou_sugestao) {
-        printf("  Nenhuma sugestao de amigo encontrada (conexao de 2o grau).\n");
+        fprintf(saida, "  Nenhuma sugestao de amigo encontrada (conexao de 2o grau).\n");
     }
-    printf("-------------------------------------------\n");
+    fprintf(saida, "-------------------------------------------\n");
 }
 
 
+#ifdef COM_SERVIDOR
+
+// Modo Servidor (a rede social servida pelo módulo servidor.c)
+//
+// Protocolo (ver servidor.h; nomes podem ter espaços):
+//   consultas: BFS <nome> | DFS <nome> | SUGERIR <nome> | AMIGOS <nome> | VERSAO
+//   escritas:  USUARIO <nome> | CONEXAO <nome1>;<nome2>
+
+// Cria um grafo vazio em memória dinâmica (versão 0 do servidor)
+void* servidorCriarGrafo(void) {
+    Grafo* g = (Grafo*)malloc(sizeof(Grafo));
+    if (g == NULL) {
+        printf("Erro de alocacao de memoria para Grafo.\n");
+        exit(EXIT_FAILURE);
+    }
+    inicializarGrafo(g);
+    return g;
+}
+
+// Cria uma cópia independente do grafo para uma nova versão
+void* servidorCopiarGrafo(void* grafo) {
+    Grafo* copia = (Grafo*)servidorCriarGrafo();
+    copiarGrafo(copia, (Grafo*)grafo);
+    return copia;
+}
+
+// Libera um grafo criado pelo servidor
+void servidorLiberarGrafo(void* grafo) {
+    liberarGrafo((Grafo*)grafo);
+    free(grafo);
+}
+
+// Verifica se uma linha do protocolo é um comando de escrita
+bool ehComandoEscrita(const char* linha) {
+    return argumentosDoComando(linha, "USUARIO") != NULL || argumentosDoComando(linha, "CONEXAO") != NULL;
+}
+
+// Executa um comando de escrita sobre um grafo que ainda não foi publicado
+// Retorna true se o grafo mudou
+bool executarEscrita(void* grafo, const char* linha, FILE* saida) {
+    Grafo* g = (Grafo*)grafo;
+    char nome1[NOME_MAX], nome2[NOME_MAX];
+    char* nomes[2] = { nome1, nome2 };
+    const char* argumentos;
+    if ((argumentos = argumentosDoComando(linha, "USUARIO")) != NULL) {
+        if (separarCampos(argumentos, nomes, 1, NOME_MAX)) {
+            return adicionarUsuario(g, nome1, saida);
+        }
+        fprintf(saida, "Nome de usuario invalido (vazio, com ';' ou com mais de %d caracteres).\n", NOME_MAX - 1);
+    } else if ((argumentos = argumentosDoComando(linha, "CONEXAO")) != NULL) {
+        if (!separarCampos(argumentos, nomes, 2, NOME_MAX)) {
+            fprintf(saida, "Use: CONEXAO <nome1>;<nome2>\n");
+            return false;
+        }
+        int id1 = obterIdUsuarioPorNome(g, nome1);
+        int id2 = obterIdUsuarioPorNome(g, nome2);
+        if (id1 != -1 && id2 != -1) {
+            return criarConexao(g, id1, id2, saida);
+        }
+        fprintf(saida, "Um ou ambos os usuarios nao foram encontrados.\n");
+    } else {
+        fprintf(saida, "Comando de escrita invalido: %s\n", linha);
+    }
+    return false;
+}
+
+// Executa uma consulta (somente leitura) sobre uma versão publicada
+void executarConsulta(void* grafo, unsigned long versao, const char* linha, FILE* saida) {
+    Grafo* g = (Grafo*)grafo;
+    if (strcmp(linha, "VERSAO") == 0) {
+        fprintf(saida, "Versao %lu (%d usuarios)\n", versao, g->num_usuarios);
+        return;
+    }
+
+    // Todas as outras consultas recebem um nome de usuário
+    const char* consultas[] = { "BFS", "DFS", "SUGERIR", "AMIGOS" };
+    int consulta = -1;
+    const char* argumentos = NULL;
+    for (int i = 0; i < 4 && consulta == -1; i++) {
+        if ((argumentos = argumentosDoComando(linha, consultas[i])) != NULL) consulta = i;
+    }
+    if (consulta == -1) {
+        fprintf(saida, "Comando invalido: %s\n", linha);
+        return;
+    }
+
+    char nome[NOME_MAX];
+    char* campos[1] = { nome };
+    if (!separarCampos(argumentos, campos, 1, NOME_MAX)) {
+        fprintf(saida, "Nome de usuario invalido (vazio, com ';' ou com mais de %d caracteres).\n", NOME_MAX - 1);
+        return;
+    }
+    int id_usuario = obterIdUsuarioPorNome(g, nome);
+    switch (consulta) {
+        case 0: bfs(g, id_usuario, saida); break;
+        case 1: dfs(g, id_usuario, saida); break;
+        case 2: sugerirAmigos(g, id_usuario, saida); break;
+        default: visualizarAmizades(g, id_usuario, saida); break;
+    }
+}
+
+// Amizades usadas pelo gerador de carga: cada u<i> só se liga a u<i+1>, u<i+2> e u<i+3>
+// Como conexões repetidas são recusadas, a carga nunca passa de 3 * MAX_USUARIOS amizades,
+// não importa quantas vezes seja executada
+#define VIZINHOS_CARGA 3
+
+// Gerador de carga: cria os usuários u0..u99 ligados em anel (u0 - u1 - ... - u99 - u0)
+void escreverPopulacaoCarga(FILE* saida, unsigned int* semente) {
+    (void)semente;
+    for (int i = 0; i < MAX_USUARIOS; i++) {
+        fprintf(saida, "USUARIO u%d\n", i); // Usuários repetidos são apenas ignorados
+    }
+    for (int i = 0; i < MAX_USUARIOS; i++) {
+        fprintf(saida, "CONEXAO u%d;u%d\n", i, (i + 1) % MAX_USUARIOS); // Idem para amizades
+    }
+}
+
+// Gerador de carga: uma consulta BFS ou SUGERIR para um usuário aleatório
+void escreverConsultaCarga(FILE* saida, unsigned int* semente) {
+    int u = sortearNumero(semente, MAX_USUARIOS);
+    fprintf(saida, "%s u%d\n", (sortearNumero(semente, 2) == 0) ? "BFS" : "SUGERIR", u);
+}
+
+// Gerador de carga: um pequeno lote de amizades entre vizinhos próximos no anel
+void escreverLoteCarga(FILE* saida, unsigned int* semente) {
+    for (int i = 0; i < 5; i++) {
+        int u = sortearNumero(semente, MAX_USUARIOS);
+        int v = (u + 1 + sortearNumero(semente, VIZINHOS_CARGA)) % MAX_USUARIOS;
+        fprintf(saida, "CONEXAO u%d;u%d\n", u, v);
+    }
+}
+
+// Funções da rede social usadas pelo servidor e pelo gerador de carga
+const OperacoesGrafo operacoesRedeSocial = {
+    "da rede social",
+    servidorCriarGrafo, servidorCopiarGrafo, servidorLiberarGrafo,
+    ehComandoEscrita, executarEscrita, executarConsulta,
+    escreverPopulacaoCarga, escreverConsultaCarga, escreverLoteCarga
+};
+
+#endif // COM_SERVIDOR
+
+
 // Função Principal (Main) 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Modos alternativos: servidor concorrente e gerador de carga
+    // Uso: --servidor [socket] [trabalhadores]  |  --carga [socket] [threads] [consultas por thread]
+    if (argc >= 2 && (strcmp(argv[1], "--servidor") == 0 || strcmp(argv[1], "--carga") == 0)) {
+#ifdef COM_SERVIDOR
+        const char* caminho = (argc >= 3) ? argv[2] : SOCKET_PADRAO;
+        int num_threads = (argc >= 4) ? atoi(argv[3]) : 4;
+        if (strcmp(argv[1], "--servidor") == 0) {
+            return iniciarServidor(caminho, num_threads, &operacoesRedeSocial);
+        }
+        return gerarCarga(caminho, num_threads, (argc >= 5) ? atoi(argv[4]) : 10000, &operacoesRedeSocial);
+#else
+        printf("Modo servidor nao incluido. Compile com: gcc -DCOM_SERVIDOR -pthread -o rede Exercicio1.c servidor.c\n");
+        return EXIT_FAILURE;
+#endif
+    }
+
     Grafo minhaRede;
     inicializarGrafo(&minhaRede); // Inicializa a rede social
 
@@ -312,7 +504,7 @@ int main() {
                 printf("Digite o nome do novo usuario: ");
                 fgets(nome, NOME_MAX, stdin);
                 nome[strcspn(nome, "\n")] = 0; // Remove o '\n' do final
-                adicionarUsuario(&minhaRede, nome);
+                adicionarUsuario(&minhaRede, nome, stdout);
                 break;
             case 2:
                 printf("Digite o nome do primeiro usuario: ");
@@ -326,7 +518,7 @@ int main() {
                 int id2 = obterIdUsuarioPorNome(&minhaRede, nome2);
 
                 if (id1 != -1 && id2 != -1) {
-                    criarConexao(&minhaRede, id1, id2);
+                    criarConexao(&minhaRede, id1, id2, stdout);
                 } else {
                     printf("Um ou ambos os usuarios nao foram encontrados.\n");
                 }
@@ -336,28 +528,28 @@ int main() {
                 fgets(nome, NOME_MAX, stdin);
                 nome[strcspn(nome, "\n")] = 0;
                 id_usuario = obterIdUsuarioPorNome(&minhaRede, nome);
-                visualizarAmizades(&minhaRede, id_usuario);
+                visualizarAmizades(&minhaRede, id_usuario, stdout);
                 break;
             case 4:
                 printf("Digite o nome do usuario de inicio para BFS: ");
                 fgets(nome, NOME_MAX, stdin);
                 nome[strcspn(nome, "\n")] = 0;
                 id_usuario = obterIdUsuarioPorNome(&minhaRede, nome);
-                bfs(&minhaRede, id_usuario);
+                bfs(&minhaRede, id_usuario, stdout);
                 break;
             case 5:
                 printf("Digite o nome do usuario de inicio para DFS: ");
                 fgets(nome, NOME_MAX, stdin);
                 nome[strcspn(nome, "\n")] = 0;
                 id_usuario = obterIdUsuarioPorNome(&minhaRede, nome);
-                dfs(&minhaRede, id_usuario);
+                dfs(&minhaRede, id_usuario, stdout);
                 break;
             case 6:
                 printf("Digite o nome do usuario para sugestao de amigos: ");
                 fgets(nome, NOME_MAX, stdin);
                 nome[strcspn(nome, "\n")] = 0;
                 id_usuario = obterIdUsuarioPorNome(&minhaRede, nome);
-                sugerirAmigos(&minhaRede, id_usuario);
+                sugerirAmigos(&minhaRede, id_usuario, stdout);
                 break;
             case 0:
                 printf("Saindo da rede social. Ate mais!\n");
@@ -2,6 +2,13 @@
 #include <stdlib.h>   // Para alocação de memória 
 #include <string.h>   // Para manipulação de strings 
 #include <stdbool.h>  // Para usar tipos booleanos 
+#include <time.h>     // Para medir o tempo na comparação do reparo incremental
+
+// O modo servidor é opcional: compile com -DCOM_SERVIDOR e junto com servidor.c para ativá-lo
+// (ex.: gcc -DCOM_SERVIDOR -pthread Exercicio2.c servidor.c). Sem isso, só este arquivo basta.
+#ifdef COM_SERVIDOR
+#include "servidor.h" // Para o modo servidor concorrente
+#endif
 
 // Definições e Estruturas 
 
@@ -9,6 +16,8 @@
 #define NOME_CIDADE_MAX 50 // Tamanho máximo do nome da cidade
 #define INFINITO 99999 // Um valor grande para representar distâncias inatingíveis
 
+#define SOCKET_PADRAO "/tmp/sistema_rotas.sock" // Caminho padrão do socket do servidor
+
 // Estrutura para representar uma cidade
 typedef struct Cidade {
     int id;                // ID único da cidade (índice no array de cidades)
@@ -29,6 +38,14 @@ typedef struct Grafo {
     int num_cidades;           // Contador de cidades atualmente no grafo
 } Grafo;
 
+// Estrutura que guarda o resultado de um Dijkstra (árvore de menores caminhos)
+// Mantida entre as operações para poder ser reparada quando as rotas mudam
+typedef struct ArvoreCaminhos {
+    int origem;            // ID da cidade de origem (-1 se a árvore ainda não foi calculada)
+    int dist[MAX_CIDADES]; // Menor distância conhecida a partir da origem
+    int pai[MAX_CIDADES];  // Cidade anterior no menor caminho
+} ArvoreCaminhos;
+
 //Funções Auxiliares
 
 // Inicializa o grafo, definindo tudo como vazio
@@ -66,6 +83,21 @@ void liberarGrafo(Grafo* g) {
     }
 }
 
+// Copia o grafo 'origem' para 'destino', duplicando as listas de adjacência
+// (a ordem das listas é mantida, então o Dijkstra escolhe os mesmos caminhos)
+void copiarGrafo(Grafo* destino, const Grafo* origem) {
+    inicializarGrafo(destino);
+    destino->num_cidades = origem->num_cidades;
+    for (int i = 0; i < origem->num_cidades; i++) {
+        destino->cidades[i] = origem->cidades[i];
+        NoRota** fim = &destino->adj[i]; // Onde o próximo nó copiado será pendurado
+        for (NoRota* atual = origem->adj[i]; atual != NULL; atual = atual->prox) {
+            *fim = criarNoRota(atual->id_destino, atual->custo);
+            fim = &(*fim)->prox;
+        }
+    }
+}
+
 // Encontra o ID de uma cidade pelo nome
 int obterIdCidadePorNome(Grafo* g, const char* nome) {
     for (int i = 0; i < g->num_cidades; i++) {
@@ -79,14 +111,15 @@ int obterIdCidadePorNome(Grafo* g, const char* nome) {
 // Funções de Gerenciamento do Grafo
 
 // Adiciona uma nova cidade ao grafo
-void adicionarCidade(Grafo* g, const char* nome) {
+// Retorna true se a cidade foi adicionada
+bool adicionarCidade(Grafo* g, const char* nome, FILE* saida) {
     if (g->num_cidades >= MAX_CIDADES) {
-        printf("Limite de cidades atingido.\n");
-        return;
+        fprintf(saida, "Limite de cidades atingido.\n");
+        return false;
     }
     if (obterIdCidadePorNome(g, nome) != -1) {
-        printf("Cidade '%s' ja existe.\n", nome);
-        return;
+        fprintf(saida, "Cidade '%s' ja existe.\n", nome);
+        return false;
     }
 
     // Encontra o próximo ID disponível
@@ -95,25 +128,33 @@ void adicionarCidade(Grafo* g, const char* nome) {
     strcpy(g->cidades[novo_id].nome, nome); // Copia o nome
     g->adj[novo_id] = NULL;                  // Inicializa a lista de adjacência vazia
     g->num_cidades++;                       // Incrementa o contador de cidades
-    printf("Cidade '%s' adicionada com sucesso! (ID: %d)\n", nome, novo_id);
+    fprintf(saida, "Cidade '%s' adicionada com sucesso! (ID: %d)\n", nome, novo_id);
+    return true;
 }
 
 // Cria uma rota (conexão ponderada) entre duas cidades
 // Assume que a rota é de mão dupla (grafo não direcionado)
-void criarRota(Grafo* g, int id_origem, int id_destino, int custo) {
+bool criarRota(Grafo* g, int id_origem, int id_destino, int custo, FILE* saida) {
     // Verifica se os IDs são válidos e se o custo é positivo
     if (id_origem < 0 || id_origem >= g->num_cidades || g->cidades[id_origem].id == -1 ||
         id_destino < 0 || id_destino >= g->num_cidades || g->cidades[id_destino].id == -1) {
-        printf("IDs de cidades invalidos para criar rota.\n");
-        return;
+        fprintf(saida, "IDs de cidades invalidos para criar rota.\n");
+        return false;
     }
     if (id_origem == id_destino) {
-        printf("Uma rota nao pode conectar a mesma cidade a si mesma.\n");
-        return;
+        fprintf(saida, "Uma rota nao pode conectar a mesma cidade a si mesma.\n");
+        return false;
     }
-    if (custo <= 0) {
-        printf("O custo da rota deve ser positivo.\n");
-        return;
+    if (custo <= 0 || custo >= INFINITO) {
+        fprintf(saida, "O custo da rota deve ser positivo e menor que %d.\n", INFINITO);
+        return false;
+    }
+    for (NoRota* atual = g->adj[id_origem]; atual != NULL; atual = atual->prox) {
+        if (atual->id_destino == id_destino) {
+            fprintf(saida, "Ja existe rota entre '%s' e '%s' (Custo: %d); use a atualizacao de custo.\n",
+                   g->cidades[id_origem].nome, g->cidades[id_destino].nome, atual->custo);
+            return false;
+        }
     }
 
     // Adiciona a rota de origem para destino
@@ -126,25 +167,63 @@ void criarRota(Grafo* g, int id_origem, int id_destino, int custo) {
     novoNo2->prox = g->adj[id_destino];
     g->adj[id_destino] = novoNo2;
 
-    printf("Rota entre '%s' e '%s' (Custo: %d) criada com sucesso!\n",
+    fprintf(saida, "Rota entre '%s' e '%s' (Custo: %d) criada com sucesso!\n",
            g->cidades[id_origem].nome, g->cidades[id_destino].nome, custo);
+    return true;
+}
+
+// Atualiza o custo de uma rota já existente entre duas cidades (nos dois sentidos)
+// Retorna o custo antigo da rota, ou -1 se a atualização não foi feita
+int atualizarCustoRota(Grafo* g, int id_origem, int id_destino, int novo_custo, FILE* saida) {
+    if (id_origem < 0 || id_origem >= g->num_cidades || g->cidades[id_origem].id == -1 ||
+        id_destino < 0 || id_destino >= g->num_cidades || g->cidades[id_destino].id == -1) {
+        fprintf(saida, "IDs de cidades invalidos para atualizar rota.\n");
+        return -1;
+    }
+    if (novo_custo <= 0 || novo_custo >= INFINITO) {
+        fprintf(saida, "O custo da rota deve ser positivo e menor que %d.\n", INFINITO);
+        return -1;
+    }
+
+    // Procura a rota nas duas listas de adjacência
+    NoRota* ida = g->adj[id_origem];
+    while (ida != NULL && ida->id_destino != id_destino) {
+        ida = ida->prox;
+    }
+    NoRota* volta = g->adj[id_destino];
+    while (volta != NULL && volta->id_destino != id_origem) {
+        volta = volta->prox;
+    }
+    if (ida == NULL || volta == NULL) {
+        fprintf(saida, "Nao existe rota entre '%s' e '%s'.\n",
+               g->cidades[id_origem].nome, g->cidades[id_destino].nome);
+        return -1;
+    }
+
+    int custo_antigo = ida->custo;
+    ida->custo = novo_custo;   // Atualiza o sentido origem -> destino
+    volta->custo = novo_custo; // Atualiza o sentido destino -> origem
+
+    fprintf(saida, "Rota entre '%s' e '%s' atualizada (Custo: %d -> %d).\n",
+           g->cidades[id_origem].nome, g->cidades[id_destino].nome, custo_antigo, novo_custo);
+    return custo_antigo;
 }
 
 // Exibe as rotas que partem de uma cidade específica
-void visualizarRotas(Grafo* g, int id_cidade) {
+void visualizarRotas(Grafo* g, int id_cidade, FILE* saida) {
     if (id_cidade < 0 || id_cidade >= g->num_cidades || g->cidades[id_cidade].id == -1) {
-        printf("Cidade nao encontrada.\n");
+        fprintf(saida, "Cidade nao encontrada.\n");
         return;
     }
 
-    printf("Rotas partindo de '%s':\n", g->cidades[id_cidade].nome);
+    fprintf(saida, "Rotas partindo de '%s':\n", g->cidades[id_cidade].nome);
     NoRota* atual = g->adj[id_cidade];
     if (atual == NULL) {
-        printf("  Nenhuma rota cadastrada.\n");
+        fprintf(saida, "  Nenhuma rota cadastrada.\n");
         return;
     }
     while (atual != NULL) {
-        printf("  - Para %s (ID: %d), Custo: %d\n", g->cidades[atual->id_destino].nome, atual->id_destino, atual->custo);
+        fprintf(saida, "  - Para %s (ID: %d), Custo: %d\n", g->cidades[atual->id_destino].nome, atual->id_destino, atual->custo);
         atual = atual->prox;
     }
 }
@@ -152,24 +231,25 @@ void visualizarRotas(Grafo* g, int id_cidade) {
 // Algoritmo de Dijkstra
 
 // Implementação do algoritmo de Dijkstra para encontrar o menor caminho
-void dijkstra(Grafo* g, int id_inicio) {
+// O resultado fica guardado em 'arv' para poder ser reparado depois
+void dijkstra(Grafo* g, int id_inicio, ArvoreCaminhos* arv, FILE* saida) {
     if (id_inicio < 0 || id_inicio >= g->num_cidades || g->cidades[id_inicio].id == -1) {
-        printf("Cidade de inicio nao encontrada para Dijkstra.\n");
+        fprintf(saida, "Cidade de inicio nao encontrada para Dijkstra.\n");
         return;
     }
 
-    int dist[MAX_CIDADES];   // Array para armazenar as menores distâncias do início
-    int pai[MAX_CIDADES];    // Array para reconstruir o caminho (quem "chegou" em quem)
     bool visitado[MAX_CIDADES]; // Array para marcar cidades já processadas
 
     // Inicializa distâncias, pais e visitados
-    for (int i = 0; i < g->num_cidades; i++) {
-        dist[i] = INFINITO;   // Todas as distâncias começam como infinito
-        pai[i] = -1;          // Nenhum pai definido ainda
-        visitado[i] = false;  // Nenhuma cidade visitada
+    // Inicializa todas as posições para que cidades adicionadas depois já comecem inatingíveis
+    for (int i = 0; i < MAX_CIDADES; i++) {
+        arv->dist[i] = INFINITO; // Todas as distâncias começam como infinito
+        arv->pai[i] = -1;        // Nenhum pai definido ainda
+        visitado[i] = false;     // Nenhuma cidade visitada
     }
 
-    dist[id_inicio] = 0; // A distância da cidade inicial para ela mesma é 0
+    arv->origem = id_inicio;
+    arv->dist[id_inicio] = 0; // A distância da cidade inicial para ela mesma é 0
 
     // Loop principal de Dijkstra: processa todas as cidades
     for (int count = 0; count < g->num_cidades - 1; count++) {
@@ -177,13 +257,13 @@ void dijkstra(Grafo* g, int id_inicio) {
 
         // Encontra a cidade 'u' com a menor distância que ainda não foi visitada
         for (int v = 0; v < g->num_cidades; v++) {
-            if (!visitado[v] && (u == -1 || dist[v] < dist[u])) {
+            if (!visitado[v] && (u == -1 || arv->dist[v] < arv->dist[u])) {
                 u = v; // Atualiza 'u' se encontrar uma distância menor
             }
         }
 
         // Se 'u' for infinito, significa que as cidades restantes não são alcançáveis
-        if (dist[u] == INFINITO) break;
+        if (arv->dist[u] == INFINITO) break;
 
         visitado[u] = true; // Marca 'u' como visitado
 
@@ -194,55 +274,528 @@ void dijkstra(Grafo* g, int id_inicio) {
             int custo_aresta = atual->custo;
 
             // Se 'v' não foi visitado e o novo caminho via 'u' é mais curto
-            if (!visitado[v] && dist[u] + custo_aresta < dist[v]) {
-                dist[v] = dist[u] + custo_aresta; // Atualiza a distância de 'v'
-                pai[v] = u; // Define 'u' como pai de 'v' no menor caminho
+            if (!visitado[v] && arv->dist[u] + custo_aresta < arv->dist[v]) {
+                arv->dist[v] = arv->dist[u] + custo_aresta; // Atualiza a distância de 'v'
+                arv->pai[v] = u; // Define 'u' como pai de 'v' no menor caminho
             }
             atual = atual->prox;
         }
     }
+}
+
+// Exibe os menores caminhos guardados na árvore
+void exibirMenoresCaminhos(Grafo* g, ArvoreCaminhos* arv, FILE* saida) {
+    if (arv->origem == -1) {
+        fprintf(saida, "Nenhum menor caminho calculado ainda. Use a opcao de Dijkstra primeiro.\n");
+        return;
+    }
 
-    // Exibe os resultados
-    printf("\n--- Menores Caminhos a partir de '%s' (Dijkstra) ---\n", g->cidades[id_inicio].nome);
+    fprintf(saida, "\n--- Menores Caminhos a partir de '%s' (Dijkstra) ---\n", g->cidades[arv->origem].nome);
     for (int i = 0; i < g->num_cidades; i++) {
-        if (i == id_inicio) continue; // Pula a cidade de início
+        if (i == arv->origem) continue; // Pula a cidade de início
 
-        printf("  Para '%s': ", g->cidades[i].nome);
-        if (dist[i] == INFINITO) {
-            printf("Inatingivel.\n");
+        fprintf(saida, "  Para '%s': ", g->cidades[i].nome);
+        if (arv->dist[i] == INFINITO) {
+            fprintf(saida, "Inatingivel.\n");
         } else {
-            printf("Custo total: %d. Caminho: ", dist[i]);
+            fprintf(saida, "Custo total: %d. Caminho: ", arv->dist[i]);
             // Reconstrói e exibe o caminho
             int caminho[MAX_CIDADES]; // Armazena o caminho invertido
             int k = 0;
             int atual_caminho = i;
             while (atual_caminho != -1) {
                 caminho[k++] = atual_caminho;
-                atual_caminho = pai[atual_caminho];
+                atual_caminho = arv->pai[atual_caminho];
             }
             // Imprime o caminho na ordem correta
             for (int j = k - 1; j >= 0; j--) {
-                printf("%s", g->cidades[caminho[j]].nome);
-                if (j > 0) printf(" -> ");
+                fprintf(saida, "%s", g->cidades[caminho[j]].nome);
+                if (j > 0) fprintf(saida, " -> ");
+            }
+            fprintf(saida, "\n");
+        }
+    }
+    fprintf(saida, "--------------------------------------------------\n");
+}
+
+// Reparo Incremental da Árvore de Menores Caminhos (estilo Ramalingam-Reps)
+
+// Propaga diminuições de distância a partir das cidades pendentes (um Dijkstra
+// restrito às cidades cuja distância melhorou). Retorna quantas cidades mudaram.
+int propagarDiminuicao(Grafo* g, ArvoreCaminhos* arv, int pendentes[], int num_pendentes) {
+    bool na_lista[MAX_CIDADES] = { false };  // Marca cidades que estão na lista de pendentes
+    bool alterada[MAX_CIDADES] = { false };  // Marca cidades que tiveram a distância alterada
+    int num_alteradas = 0;
+
+    for (int i = 0; i < num_pendentes; i++) {
+        na_lista[pendentes[i]] = true;
+        alterada[pendentes[i]] = true;
+        num_alteradas++;
+    }
+
+    while (num_pendentes > 0) {
+        // Escolhe a pendente com menor distância (a lista só contém cidades afetadas)
+        int menor = 0;
+        for (int i = 1; i < num_pendentes; i++) {
+            if (arv->dist[pendentes[i]] < arv->dist[pendentes[menor]]) {
+                menor = i;
+            }
+        }
+        int u = pendentes[menor];
+        pendentes[menor] = pendentes[--num_pendentes]; // Remove 'u' da lista
+        na_lista[u] = false;
+
+        // Relaxa as rotas de 'u'; só entra na lista quem realmente melhorar
+        NoRota* atual = g->adj[u];
+        while (atual != NULL) {
+            int v = atual->id_destino;
+            if (arv->dist[u] + atual->custo < arv->dist[v]) {
+                arv->dist[v] = arv->dist[u] + atual->custo;
+                arv->pai[v] = u;
+                if (!na_lista[v]) {
+                    na_lista[v] = true;
+                    pendentes[num_pendentes++] = v;
+                }
+                if (!alterada[v]) {
+                    alterada[v] = true;
+                    num_alteradas++;
+                }
             }
-            printf("\n");
+            atual = atual->prox;
+        }
+    }
+    return num_alteradas;
+}
+
+// Repara a árvore depois que a rota entre 'a' e 'b' foi criada ou ficou mais barata
+// Retorna quantas cidades tiveram a distância alterada
+int repararAposDiminuicao(Grafo* g, ArvoreCaminhos* arv, int a, int b, int custo) {
+    int pendentes[MAX_CIDADES];
+    int num_pendentes = 0;
+
+    // A rota é de mão dupla: testa os dois sentidos
+    if (arv->dist[a] != INFINITO && arv->dist[a] + custo < arv->dist[b]) {
+        arv->dist[b] = arv->dist[a] + custo;
+        arv->pai[b] = a;
+        pendentes[num_pendentes++] = b;
+    } else if (arv->dist[b] != INFINITO && arv->dist[b] + custo < arv->dist[a]) {
+        arv->dist[a] = arv->dist[b] + custo;
+        arv->pai[a] = b;
+        pendentes[num_pendentes++] = a;
+    }
+
+    if (num_pendentes == 0) return 0; // A rota não melhora nenhum caminho
+    return propagarDiminuicao(g, arv, pendentes, num_pendentes);
+}
+
+// Repara a árvore depois que a rota entre 'a' e 'b' ficou mais cara
+// Só a subárvore pendurada nessa rota pode mudar. Retorna quantas cidades foram recalculadas.
+int repararAposAumento(Grafo* g, ArvoreCaminhos* arv, int a, int b) {
+    int filho;
+    if (arv->pai[b] == a) {
+        filho = b;
+    } else if (arv->pai[a] == b) {
+        filho = a;
+    } else {
+        return 0; // A rota não faz parte da árvore: nenhuma distância muda
+    }
+
+    // Coleta a subárvore de 'filho'. Todo filho de 'x' na árvore é vizinho de 'x',
+    // então basta olhar a lista de adjacência de cada cidade afetada.
+    bool afetada[MAX_CIDADES] = { false };
+    int subarvore[MAX_CIDADES];
+    int num_afetadas = 0;
+    subarvore[num_afetadas++] = filho;
+    afetada[filho] = true;
+    for (int i = 0; i < num_afetadas; i++) {
+        int x = subarvore[i];
+        NoRota* atual = g->adj[x];
+        while (atual != NULL) {
+            int y = atual->id_destino;
+            if (!afetada[y] && arv->pai[y] == x) {
+                afetada[y] = true;
+                subarvore[num_afetadas++] = y;
+            }
+            atual = atual->prox;
+        }
+    }
+
+    // Cada cidade afetada recebe a melhor distância vinda de fora da subárvore
+    int pendentes[MAX_CIDADES];
+    int num_pendentes = 0;
+    for (int i = 0; i < num_afetadas; i++) {
+        int x = subarvore[i];
+        arv->dist[x] = INFINITO;
+        arv->pai[x] = -1;
+        NoRota* atual = g->adj[x];
+        while (atual != NULL) {
+            int y = atual->id_destino;
+            if (!afetada[y] && arv->dist[y] != INFINITO && arv->dist[y] + atual->custo < arv->dist[x]) {
+                arv->dist[x] = arv->dist[y] + atual->custo;
+                arv->pai[x] = y;
+            }
+            atual = atual->prox;
         }
+        if (arv->dist[x] != INFINITO) {
+            pendentes[num_pendentes++] = x;
+        }
+    }
+
+    // Termina com um Dijkstra restrito à subárvore (fora dela nada pode melhorar)
+    if (num_pendentes > 0) {
+        propagarDiminuicao(g, arv, pendentes, num_pendentes);
+    }
+    return num_afetadas;
+}
+
+// Repara a árvore guardada após a mudança de custo da rota entre 'a' e 'b'
+// Use custo_antigo = INFINITO quando a rota acabou de ser criada
+void repararArvore(Grafo* g, ArvoreCaminhos* arv, int a, int b, int custo_antigo, int custo_novo, FILE* saida) {
+    if (arv->origem == -1) return; // Nenhuma árvore para reparar
+
+    int num_cidades_alteradas = 0;
+    if (custo_novo < custo_antigo) {
+        num_cidades_alteradas = repararAposDiminuicao(g, arv, a, b, custo_novo);
+    } else if (custo_novo > custo_antigo) {
+        num_cidades_alteradas = repararAposAumento(g, arv, a, b);
     }
-    printf("--------------------------------------------------\n");
+    fprintf(saida, "Menores caminhos a partir de '%s' reparados (%d cidade(s) afetada(s)).\n",
+           g->cidades[arv->origem].nome, num_cidades_alteradas);
 }
 
 
+// Comparação do Reparo Incremental com o Dijkstra Completo (--bench-reparo)
+
+// O que fazer com a árvore depois de cada mudança em executarSequencia
+#define MODO_REPARO 0      // Só repara a árvore (medido)
+#define MODO_RECALCULO 1   // Só recalcula a árvore do zero (medido)
+#define MODO_VERIFICACAO 2 // Repara, recalcula e compara (não medido)
+
+// Conta as cidades em que a árvore reparada 'arv' não bate com a recalculada 'ref'
+// As distâncias têm de ser iguais; o pai pode mudar em empates, mas tem de formar um menor caminho
+int contarDivergencias(Grafo* g, ArvoreCaminhos* arv, ArvoreCaminhos* ref) {
+    int divergencias = 0;
+    for (int i = 0; i < g->num_cidades; i++) {
+        if (arv->dist[i] != ref->dist[i]) {
+            divergencias++;
+            continue;
+        }
+        if (i == arv->origem || arv->dist[i] == INFINITO) continue;
+
+        int p = arv->pai[i];
+        bool pai_valido = false;
+        if (p >= 0 && p < g->num_cidades) {
+            for (NoRota* atual = g->adj[p]; atual != NULL; atual = atual->prox) {
+                if (atual->id_destino == i && arv->dist[p] + atual->custo == arv->dist[i]) {
+                    pai_valido = true;
+                }
+            }
+        }
+        if (!pai_valido) divergencias++;
+    }
+    return divergencias;
+}
+
+// Executa a mesma sequência aleatória de mudanças (definida por 'semente') em vários grafos
+// Cada grafo começa com 80 cidades e recebe novas rotas, mudanças de custo e novas cidades.
+// Retorna o número de divergências encontradas (só no MODO_VERIFICACAO).
+long executarSequencia(int modo, unsigned int semente, int num_grafos, int num_operacoes, FILE* descarte) {
+    Grafo g;
+    ArvoreCaminhos arv, ref;
+    char nome[NOME_CIDADE_MAX];
+    long divergencias = 0;
+    srand(semente);
+
+    for (int k = 0; k < num_grafos; k++) {
+        inicializarGrafo(&g);
+        for (int i = 0; i < MAX_CIDADES * 4 / 5; i++) {
+            sprintf(nome, "c%d", i);
+            adicionarCidade(&g, nome, descarte);
+        }
+        for (int i = 0; i < 2 * g.num_cidades; i++) {
+            criarRota(&g, rand() % g.num_cidades, rand() % g.num_cidades, 1 + rand() % 100, descarte);
+        }
+        dijkstra(&g, 0, &arv, descarte);
+
+        for (int op = 0; op < num_operacoes; op++) {
+            int tipo = rand() % 10;
+            int a = rand() % g.num_cidades;
+            int b = rand() % g.num_cidades;
+            int custo = 1 + rand() % 100;
+
+            if (tipo == 0) {
+                // Nova cidade: começa inatingível, a árvore não muda
+                sprintf(nome, "c%d", g.num_cidades);
+                adicionarCidade(&g, nome, descarte);
+            } else if (tipo <= 3) {
+                // Nova rota
+                if (criarRota(&g, a, b, custo, descarte) && modo != MODO_RECALCULO) {
+                    repararArvore(&g, &arv, a, b, INFINITO, custo, descarte);
+                }
+            } else if (g.adj[a] != NULL) {
+                // Mudança de custo (para mais ou para menos) de uma rota que já existe
+                b = g.adj[a]->id_destino;
+                int custo_antigo = atualizarCustoRota(&g, a, b, custo, descarte);
+                if (custo_antigo != -1 && modo != MODO_RECALCULO) {
+                    repararArvore(&g, &arv, a, b, custo_antigo, custo, descarte);
+                }
+            }
+
+            if (modo == MODO_RECALCULO) {
+                dijkstra(&g, 0, &arv, descarte);
+            } else if (modo == MODO_VERIFICACAO) {
+                dijkstra(&g, 0, &ref, descarte);
+                divergencias += contarDivergencias(&g, &arv, &ref);
+            }
+        }
+        liberarGrafo(&g);
+    }
+    return divergencias;
+}
+
+// Compara o reparo incremental com o Dijkstra completo na mesma sequência de mudanças
+// Primeiro confere cada reparo contra o Dijkstra; depois mede os dois modos separadamente
+int compararReparo(int num_grafos, int num_operacoes) {
+#ifdef _WIN32
+    FILE* descarte = fopen("NUL", "w");       // As mensagens das operações são descartadas
+#else
+    FILE* descarte = fopen("/dev/null", "w");
+#endif
+    if (descarte == NULL) {
+        printf("Nao foi possivel abrir o arquivo de descarte.\n");
+        return EXIT_FAILURE;
+    }
+    unsigned int semente = 2024;
+
+    long divergencias = executarSequencia(MODO_VERIFICACAO, semente, num_grafos, num_operacoes, descarte);
+
+    clock_t inicio = clock();
+    executarSequencia(MODO_REPARO, semente, num_grafos, num_operacoes, descarte);
+    double tempo_reparo = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+
+    inicio = clock();
+    executarSequencia(MODO_RECALCULO, semente, num_grafos, num_operacoes, descarte);
+    double tempo_recalculo = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+
+    fclose(descarte);
+
+    printf("Grafos: %d x %d operacoes (novas rotas, mudancas de custo e novas cidades)\n",
+           num_grafos, num_operacoes);
+    printf("Divergencias do reparo em relacao ao Dijkstra completo: %ld\n", divergencias);
+    printf("Reparo incremental:      %.3f s\n", tempo_reparo);
+    printf("Dijkstra a cada mudanca: %.3f s\n", tempo_recalculo);
+    if (tempo_reparo > 0) {
+        printf("Aceleracao: %.1fx\n", tempo_recalculo / tempo_reparo);
+    }
+    printf("(os dois tempos incluem as proprias mudancas no grafo)\n");
+    return divergencias == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+#ifdef COM_SERVIDOR
+
+// Modo Servidor (o mapa de rotas servido pelo módulo servidor.c)
+//
+// Protocolo (ver servidor.h; nomes podem ter espaços):
+//   consultas: DIJKSTRA <nome> | ROTAS <nome> | VERSAO
+//   escritas:  CIDADE <nome> | ROTA <origem>;<destino>;<custo> | ATUALIZAR <origem>;<destino>;<custo>
+
+// Cria um grafo vazio em memória dinâmica (versão 0 do servidor)
+void* servidorCriarGrafo(void) {
+    Grafo* g = (Grafo*)malloc(sizeof(Grafo));
+    if (g == NULL) {
+        printf("Erro de alocacao de memoria para Grafo.\n");
+        exit(EXIT_FAILURE);
+    }
+    inicializarGrafo(g);
+    return g;
+}
+
+// Cria uma cópia independente do grafo para uma nova versão
+void* servidorCopiarGrafo(void* grafo) {
+    Grafo* copia = (Grafo*)servidorCriarGrafo();
+    copiarGrafo(copia, (Grafo*)grafo);
+    return copia;
+}
+
+// Libera um grafo criado pelo servidor
+void servidorLiberarGrafo(void* grafo) {
+    liberarGrafo((Grafo*)grafo);
+    free(grafo);
+}
+
+// Verifica se uma linha do protocolo é um comando de escrita
+bool ehComandoEscrita(const char* linha) {
+    return argumentosDoComando(linha, "CIDADE") != NULL || argumentosDoComando(linha, "ROTA") != NULL ||
+           argumentosDoComando(linha, "ATUALIZAR") != NULL;
+}
+
+// Executa um comando de escrita sobre um grafo que ainda não foi publicado
+// Retorna true se o grafo mudou
+bool executarEscrita(void* grafo, const char* linha, FILE* saida) {
+    Grafo* g = (Grafo*)grafo;
+    char nome1[NOME_CIDADE_MAX], nome2[NOME_CIDADE_MAX], texto_custo[NOME_CIDADE_MAX];
+    char* campos[3] = { nome1, nome2, texto_custo };
+    const char* argumentos;
+    bool criar = false;
+
+    if ((argumentos = argumentosDoComando(linha, "CIDADE")) != NULL) {
+        if (separarCampos(argumentos, campos, 1, NOME_CIDADE_MAX)) {
+            return adicionarCidade(g, nome1, saida);
+        }
+        fprintf(saida, "Nome de cidade invalido (vazio, com ';' ou com mais de %d caracteres).\n",
+                NOME_CIDADE_MAX - 1);
+        return false;
+    }
+    if ((argumentos = argumentosDoComando(linha, "ROTA")) != NULL) {
+        criar = true;
+    } else if ((argumentos = argumentosDoComando(linha, "ATUALIZAR")) == NULL) {
+        fprintf(saida, "Comando de escrita invalido: %s\n", linha);
+        return false;
+    }
+
+    // ROTA e ATUALIZAR recebem <origem>;<destino>;<custo>
+    char* fim_custo = NULL;
+    long custo = 0;
+    if (separarCampos(argumentos, campos, 3, NOME_CIDADE_MAX)) {
+        custo = strtol(texto_custo, &fim_custo, 10);
+    }
+    // O custo precisa ficar abaixo de INFINITO, que marca as cidades inatingíveis
+    if (custo <= 0 || *fim_custo != 0 || custo >= INFINITO) {
+        fprintf(saida, "Use: %s <origem>;<destino>;<custo> (custo inteiro positivo menor que %d)\n",
+                criar ? "ROTA" : "ATUALIZAR", INFINITO);
+        return false;
+    }
+    int id_origem = obterIdCidadePorNome(g, nome1);
+    int id_destino = obterIdCidadePorNome(g, nome2);
+    if (id_origem == -1 || id_destino == -1) {
+        fprintf(saida, "Uma ou ambas as cidades nao foram encontradas.\n");
+        return false;
+    }
+    if (criar) {
+        return criarRota(g, id_origem, id_destino, (int)custo, saida);
+    }
+    int custo_antigo = atualizarCustoRota(g, id_origem, id_destino, (int)custo, saida);
+    return custo_antigo != -1 && custo_antigo != custo; // Mesmo custo: nada mudou
+}
+
+// Executa uma consulta (somente leitura) sobre uma versão publicada
+void executarConsulta(void* grafo, unsigned long versao, const char* linha, FILE* saida) {
+    Grafo* g = (Grafo*)grafo;
+    if (strcmp(linha, "VERSAO") == 0) {
+        fprintf(saida, "Versao %lu (%d cidades)\n", versao, g->num_cidades);
+        return;
+    }
+
+    // As outras consultas recebem um nome de cidade
+    bool eh_dijkstra = true;
+    const char* argumentos = argumentosDoComando(linha, "DIJKSTRA");
+    if (argumentos == NULL) {
+        eh_dijkstra = false;
+        argumentos = argumentosDoComando(linha, "ROTAS");
+    }
+    if (argumentos == NULL) {
+        fprintf(saida, "Comando invalido: %s\n", linha);
+        return;
+    }
+
+    char nome[NOME_CIDADE_MAX];
+    char* campos[1] = { nome };
+    if (!separarCampos(argumentos, campos, 1, NOME_CIDADE_MAX)) {
+        fprintf(saida, "Nome de cidade invalido (vazio, com ';' ou com mais de %d caracteres).\n",
+                NOME_CIDADE_MAX - 1);
+        return;
+    }
+    int id_cidade = obterIdCidadePorNome(g, nome);
+    if (eh_dijkstra) {
+        // Cada consulta usa sua própria árvore: nada é compartilhado entre trabalhadores
+        ArvoreCaminhos arv;
+        arv.origem = -1;
+        dijkstra(g, id_cidade, &arv, saida);
+        if (id_cidade != -1) {
+            exibirMenoresCaminhos(g, &arv, saida);
+        }
+    } else {
+        visualizarRotas(g, id_cidade, saida);
+    }
+}
+
+// Gerador de carga: cria as cidades c0..c99, um anel c0 - c1 - ... - c99 e um atalho por cidade
+// Os pares são sempre os mesmos e rotas repetidas são recusadas, então popular de novo não
+// aumenta o grafo
+void escreverPopulacaoCarga(FILE* saida, unsigned int* semente) {
+    for (int i = 0; i < MAX_CIDADES; i++) {
+        fprintf(saida, "CIDADE c%d\n", i); // Cidades repetidas são apenas ignoradas
+    }
+    for (int i = 0; i < MAX_CIDADES; i++) {
+        fprintf(saida, "ROTA c%d;c%d;%d\n", i, (i + 1) % MAX_CIDADES, 1 + sortearNumero(semente, 100));
+    }
+    for (int i = 0; i < MAX_CIDADES; i++) {
+        // 37 * i + 11 nunca é i (mod 100), então o atalho nunca liga uma cidade a ela mesma
+        fprintf(saida, "ROTA c%d;c%d;%d\n", i, (37 * i + 11) % MAX_CIDADES, 1 + sortearNumero(semente, 100));
+    }
+}
+
+// Gerador de carga: uma consulta DIJKSTRA ou ROTAS para uma cidade aleatória
+void escreverConsultaCarga(FILE* saida, unsigned int* semente) {
+    int cidade = sortearNumero(semente, MAX_CIDADES);
+    fprintf(saida, "%s c%d\n", (sortearNumero(semente, 2) == 0) ? "DIJKSTRA" : "ROTAS", cidade);
+}
+
+// Gerador de carga: mudanças de custo (tráfego) nas rotas do anel, que sempre existem
+void escreverLoteCarga(FILE* saida, unsigned int* semente) {
+    for (int i = 0; i < 5; i++) {
+        int cidade = sortearNumero(semente, MAX_CIDADES);
+        fprintf(saida, "ATUALIZAR c%d;c%d;%d\n", cidade, (cidade + 1) % MAX_CIDADES, 1 + sortearNumero(semente, 100));
+    }
+}
+
+// Funções do mapa de rotas usadas pelo servidor e pelo gerador de carga
+const OperacoesGrafo operacoesRotas = {
+    "de rotas",
+    servidorCriarGrafo, servidorCopiarGrafo, servidorLiberarGrafo,
+    ehComandoEscrita, executarEscrita, executarConsulta,
+    escreverPopulacaoCarga, escreverConsultaCarga, escreverLoteCarga
+};
+
+#endif // COM_SERVIDOR
+
+
 // Função Principal (Main)
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Modos alternativos: servidor concorrente, gerador de carga e comparação do reparo
+    // Uso: --servidor [socket] [trabalhadores]  |  --carga [socket] [threads] [consultas por thread]
+    //      --bench-reparo [grafos] [operacoes por grafo]
+    if (argc >= 2 && strcmp(argv[1], "--bench-reparo") == 0) {
+        return compararReparo((argc >= 3) ? atoi(argv[2]) : 100, (argc >= 4) ? atoi(argv[3]) : 300);
+    }
+    if (argc >= 2 && (strcmp(argv[1], "--servidor") == 0 || strcmp(argv[1], "--carga") == 0)) {
+#ifdef COM_SERVIDOR
+        const char* caminho = (argc >= 3) ? argv[2] : SOCKET_PADRAO;
+        int num_threads = (argc >= 4) ? atoi(argv[3]) : 4;
+        if (strcmp(argv[1], "--servidor") == 0) {
+            return iniciarServidor(caminho, num_threads, &operacoesRotas);
+        }
+        return gerarCarga(caminho, num_threads, (argc >= 5) ? atoi(argv[4]) : 10000, &operacoesRotas);
+#else
+        printf("Modo servidor nao incluido. Compile com: gcc -DCOM_SERVIDOR -pthread -o rotas Exercicio2.c servidor.c\n");
+        return EXIT_FAILURE;
+#endif
+    }
+
     Grafo meuMapa;
     inicializarGrafo(&meuMapa); // Inicializa o mapa de cidades
 
+    ArvoreCaminhos menoresCaminhos; // Último Dijkstra calculado, mantido atualizado
+    menoresCaminhos.origem = -1;    // Nenhum menor caminho calculado ainda
+
     int opcao;
     char nome[NOME_CIDADE_MAX];
     char nome_origem[NOME_CIDADE_MAX], nome_destino[NOME_CIDADE_MAX];
     int id_cidade, custo_rota;
     int id_origem, id_destino;
+    int custo_antigo;
 
     do {
         printf("\n--- Menu do Sistema de Rotas --- (Cidades cadastradas: %d)\n", meuMapa.num_cidades);
@@ -250,6 +803,8 @@ int main() {
         printf("2. Criar Rota\n");
         printf("3. Visualizar Rotas de uma Cidade\n");
         printf("4. Calcular Menor Caminho (Dijkstra)\n");
+        printf("5. Atualizar Custo de Rota\n");
+        printf("6. Exibir Menores Caminhos Atuais\n");
         printf("0. Sair\n");
         printf("Escolha uma opcao: ");
         scanf("%d", &opcao);
@@ -260,7 +815,7 @@ int main() {
                 printf("Digite o nome da nova cidade: ");
                 fgets(nome, NOME_CIDADE_MAX, stdin);
                 nome[strcspn(nome, "\n")] = 0; // Remove o '\n' do final
-                adicionarCidade(&meuMapa, nome);
+                adicionarCidade(&meuMapa, nome, stdout);
                 break;
             case 2:
                 printf("Digite o nome da cidade de origem: ");
@@ -277,7 +832,10 @@ int main() {
                 id_destino = obterIdCidadePorNome(&meuMapa, nome_destino);
 
                 if (id_origem != -1 && id_destino != -1) {
-                    criarRota(&meuMapa, id_origem, id_destino, custo_rota);
+                    if (criarRota(&meuMapa, id_origem, id_destino, custo_rota, stdout)) {
+                        // Uma rota nova equivale a uma rota de custo infinito que ficou mais barata
+                        repararArvore(&meuMapa, &menoresCaminhos, id_origem, id_destino, INFINITO, custo_rota, stdout);
+                    }
                 } else {
                     printf("Uma ou ambas as cidades nao foram encontradas.\n");
                 }
@@ -287,14 +845,43 @@ int main() {
                 fgets(nome, NOME_CIDADE_MAX, stdin);
                 nome[strcspn(nome, "\n")] = 0;
                 id_cidade = obterIdCidadePorNome(&meuMapa, nome);
-                visualizarRotas(&meuMapa, id_cidade);
+                visualizarRotas(&meuMapa, id_cidade, stdout);
                 break;
             case 4:
                 printf("Digite o nome da cidade de inicio para o calculo do menor caminho: ");
                 fgets(nome, NOME_CIDADE_MAX, stdin);
                 nome[strcspn(nome, "\n")] = 0;
                 id_cidade = obterIdCidadePorNome(&meuMapa, nome);
-                dijkstra(&meuMapa, id_cidade);
+                dijkstra(&meuMapa, id_cidade, &menoresCaminhos, stdout);
+                if (id_cidade != -1 && menoresCaminhos.origem == id_cidade) {
+                    exibirMenoresCaminhos(&meuMapa, &menoresCaminhos, stdout);
+                }
+                break;
+            case 5:
+                printf("Digite o nome da cidade de origem: ");
+                fgets(nome_origem, NOME_CIDADE_MAX, stdin);
+                nome_origem[strcspn(nome_origem, "\n")] = 0;
+                printf("Digite o nome da cidade de destino: ");
+                fgets(nome_destino, NOME_CIDADE_MAX, stdin);
+                nome_destino[strcspn(nome_destino, "\n")] = 0;
+                printf("Digite o novo custo da rota: ");
+                scanf("%d", &custo_rota);
+                getchar(); // Consome o '\n'
+
+                id_origem = obterIdCidadePorNome(&meuMapa, nome_origem);
+                id_destino = obterIdCidadePorNome(&meuMapa, nome_destino);
+
+                if (id_origem != -1 && id_destino != -1) {
+                    custo_antigo = atualizarCustoRota(&meuMapa, id_origem, id_destino, custo_rota, stdout);
+                    if (custo_antigo != -1) {
+                        repararArvore(&meuMapa, &menoresCaminhos, id_origem, id_destino, custo_antigo, custo_rota, stdout);
+                    }
+                } else {
+                    printf("Uma ou ambas as cidades nao foram encontradas.\n");
+                }
+                break;
+            case 6:
+                exibirMenoresCaminhos(&meuMapa, &menoresCaminhos, stdout);
                 break;
             case 0:
                 printf("Saindo do sistema de rotas. Boa viagem!\n");
@@ -0,0 +1,865 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // Para fdopen, open_memstream, nanosleep e clock_gettime
+#endif
+
+#include <stdio.h>    // Para entrada e saída
+#include <stdlib.h>   // Para alocação de memória (malloc, free)
+#include <string.h>   // Para manipulação de strings (strcpy, strcmp)
+#include <stdbool.h>  // Para usar tipos booleanos (true/false)
+
+#include "servidor.h"
+
+#define TAM_BUFFER ((MAX_LOTE + 2) * (TAM_LINHA + 1)) // Cabe o maior lote válido ('\r\n' incluídos)
+
+// Sorteia um número em [0, limite) (gerador congruente linear, uma semente por thread)
+int sortearNumero(unsigned int* semente, int limite) {
+    *semente = *semente * 1103515245u + 12345u;
+    return (int)((*semente >> 16) % (unsigned int)limite);
+}
+
+// Devolve os argumentos de 'linha' se ela for o comando 'comando' seguido de espaço, ou NULL
+const char* argumentosDoComando(const char* linha, const char* comando) {
+    size_t tam = strlen(comando);
+    if (strncmp(linha, comando, tam) != 0 || linha[tam] != ' ') return NULL;
+    return linha + tam + 1;
+}
+
+// Separa 'argumentos' em exatamente 'num_campos' campos divididos por ';'
+bool separarCampos(const char* argumentos, char* campos[], int num_campos, size_t tam_campo) {
+    const char* atual = argumentos;
+    for (int i = 0; i < num_campos; i++) {
+        const char* fim = strchr(atual, ';');
+        if (fim == NULL) fim = atual + strlen(atual);
+        if ((*fim == ';') != (i < num_campos - 1)) return false; // Campos de menos ou de mais
+
+        // Tira os espaços das pontas
+        const char* inicio = atual;
+        const char* ultimo = fim;
+        while (inicio < ultimo && *inicio == ' ') inicio++;
+        while (ultimo > inicio && ultimo[-1] == ' ') ultimo--;
+        size_t tam = (size_t)(ultimo - inicio);
+        if (tam == 0 || tam >= tam_campo) return false;
+
+        memcpy(campos[i], inicio, tam);
+        campos[i][tam] = 0;
+        atual = fim + 1;
+    }
+    return true;
+}
+
+#ifndef _WIN32
+
+#include <errno.h>      // Para tratar chamadas interrompidas (EINTR)
+#include <poll.h>       // Para esperar dados em várias conexões ao mesmo tempo
+#include <signal.h>     // Para ignorar SIGPIPE quando um cliente desconecta
+#include <stdatomic.h>  // Para publicar versões do grafo de forma atômica
+#include <stdint.h>     // Para passar o índice do trabalhador como ponteiro (intptr_t)
+#include <pthread.h>    // Para as threads do servidor e do gerador de carga
+#include <time.h>       // Para medir a vazão do gerador de carga
+#include <unistd.h>     // Para close, dup, pipe, read, write e unlink
+#include <sys/socket.h> // Para o socket local do servidor
+#include <sys/un.h>     // Para o endereço do socket local (AF_UNIX)
+
+// Uma versão publicada do grafo. Depois de publicada nunca mais é alterada.
+typedef struct Versao {
+    void* grafo;                  // Cópia do grafo nesta versão
+    unsigned long numero;         // Número da versão (cresce a cada lote aplicado)
+    struct Versao* prox_retirada; // Próxima versão na lista de versões aguardando liberação
+} Versao;
+
+static const OperacoesGrafo* operacoes = NULL;            // Funções do grafo servido
+static _Atomic(Versao*) versao_atual = NULL;              // Versão vista pelas novas consultas
+static _Atomic(Versao*) versao_em_uso[MAX_TRABALHADORES]; // Versão que cada trabalhador está lendo
+static Versao* versoes_retiradas = NULL; // Versões antigas ainda não liberadas (só o escritor usa)
+static int socket_servidor = -1;         // Socket onde novas conexões são aceitas
+
+// Obtém a versão atual e a registra como em uso pelo trabalhador 'slot'
+// O registro é conferido de novo para não pegar uma versão que acabou de ser retirada
+static Versao* adquirirVersao(int slot) {
+    Versao* v;
+    do {
+        v = atomic_load(&versao_atual);
+        atomic_store(&versao_em_uso[slot], v);
+    } while (v != atomic_load(&versao_atual));
+    return v;
+}
+
+// Indica que o trabalhador 'slot' terminou de ler sua versão
+static void soltarVersao(int slot) {
+    atomic_store(&versao_em_uso[slot], NULL);
+}
+
+// Publica uma nova versão e libera as antigas que nenhum trabalhador está lendo
+// Só a thread escritora chama esta função
+static void publicarVersao(Versao* nova) {
+    Versao* antiga = atomic_exchange(&versao_atual, nova);
+    antiga->prox_retirada = versoes_retiradas;
+    versoes_retiradas = antiga;
+
+    Versao** ptr = &versoes_retiradas;
+    while (*ptr != NULL) {
+        Versao* v = *ptr;
+        bool em_uso = false;
+        for (int i = 0; i < MAX_TRABALHADORES && !em_uso; i++) {
+            em_uso = (atomic_load(&versao_em_uso[i]) == v);
+        }
+        if (em_uso) {
+            ptr = &v->prox_retirada; // Alguém ainda lê esta versão: fica para a próxima
+        } else {
+            *ptr = v->prox_retirada;
+            operacoes->liberarGrafo(v->grafo);
+            free(v);
+        }
+    }
+}
+
+// Uma conexão de cliente. Fica no poll enquanto está ociosa e só ocupa um trabalhador
+// quando chegam dados, então clientes parados não prendem nenhuma thread.
+typedef struct Conexao {
+    int fd;                 // Socket do cliente
+    char* buffer;           // Bytes recebidos e ainda não processados
+    size_t usado;           // Quantos bytes do buffer estão ocupados
+    bool descartando;       // Descartando o resto de uma linha longa demais
+    bool retomar;           // Voltou do escritor: processar o buffer antes de ler de novo
+    struct Conexao* prox;   // Próxima conexão na fila de prontas ou de devolvidas
+} Conexao;
+
+// Uma escrita (comando isolado ou LOTE) esperando a thread escritora
+// A conexão fica com o escritor até a resposta ser enviada, para manter a ordem dos comandos
+typedef struct PedidoEscrita {
+    Conexao* conexao;             // Quem enviou (recebe a resposta)
+    char (*linhas)[TAM_LINHA];    // Comandos de escrita, na ordem recebida
+    int num_linhas;
+    struct PedidoEscrita* prox;   // Próximo pedido na fila do escritor
+} PedidoEscrita;
+
+// Filas entre a thread do poll e os trabalhadores. O mutex protege só as filas:
+// as consultas ao grafo continuam sem nenhum lock.
+static pthread_mutex_t mutex_filas = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tem_conexao_pronta = PTHREAD_COND_INITIALIZER;
+static Conexao* prontas_inicio = NULL;   // Conexões com dados esperando um trabalhador
+static Conexao* prontas_fim = NULL;
+static Conexao* devolvidas = NULL;       // Conexões atendidas que voltam para o poll
+static int pipe_despertar[2] = { -1, -1 }; // Acorda o poll quando uma conexão é devolvida
+static atomic_int num_conexoes = 0;      // Conexões abertas (limitadas a MAX_CONEXOES)
+
+// Fila da thread escritora. Os trabalhadores só enfileiram; nunca esperam uma escrita terminar.
+static pthread_mutex_t mutex_pedidos = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tem_pedido = PTHREAD_COND_INITIALIZER;
+static PedidoEscrita* pedidos_inicio = NULL;
+static PedidoEscrita* pedidos_fim = NULL;
+
+// Coloca uma conexão com dados na fila dos trabalhadores
+static void enfileirarConexao(Conexao* c) {
+    c->prox = NULL;
+    pthread_mutex_lock(&mutex_filas);
+    if (prontas_fim == NULL) {
+        prontas_inicio = c;
+    } else {
+        prontas_fim->prox = c;
+    }
+    prontas_fim = c;
+    pthread_cond_signal(&tem_conexao_pronta);
+    pthread_mutex_unlock(&mutex_filas);
+}
+
+// Devolve uma conexão atendida para a thread do poll
+static void devolverConexao(Conexao* c) {
+    pthread_mutex_lock(&mutex_filas);
+    c->prox = devolvidas;
+    devolvidas = c;
+    pthread_mutex_unlock(&mutex_filas);
+    char sinal = 0;
+    if (write(pipe_despertar[1], &sinal, 1) < 0) {
+        perror("write"); // O poll ainda acorda quando outra conexão for devolvida
+    }
+}
+
+// Fecha a conexão e libera seus recursos
+static void fecharConexao(Conexao* c) {
+    close(c->fd);
+    free(c->buffer);
+    free(c);
+    atomic_fetch_sub(&num_conexoes, 1);
+}
+
+// Envia todos os bytes da resposta; retorna false se o cliente desconectou
+static bool enviarTudo(int fd, const char* dados, size_t tamanho) {
+    while (tamanho > 0) {
+        ssize_t enviados = write(fd, dados, tamanho);
+        if (enviados < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        dados += enviados;
+        tamanho -= (size_t)enviados;
+    }
+    return true;
+}
+
+// Lê a próxima linha completa do buffer a partir de 'inicio'
+// Retorna false se a linha ainda não chegou inteira. 'consumido' inclui o '\n';
+// 'longa' indica que a linha passa de TAM_LINHA - 1 caracteres e não foi copiada.
+static bool proximaLinha(Conexao* c, size_t inicio, char linha[TAM_LINHA], size_t* consumido, bool* longa) {
+    char* base = c->buffer + inicio;
+    char* fim = memchr(base, '\n', c->usado - inicio);
+    if (fim == NULL) return false;
+
+    size_t comprimento = (size_t)(fim - base);
+    *consumido = comprimento + 1;
+    if (comprimento > 0 && base[comprimento - 1] == '\r') comprimento--;
+    *longa = (comprimento >= TAM_LINHA);
+    if (!*longa) {
+        memcpy(linha, base, comprimento);
+        linha[comprimento] = 0;
+    }
+    return true;
+}
+
+// Monta em 'lote' o lote que começa em 'inicio' (logo depois da linha LOTE)
+// Retorna false se o FIM do lote ainda não chegou; senão 'fim_lote' aponta para depois do FIM
+// e 'num_linhas' recebe o número de comandos, ou -1 se o lote foi recusado (já respondido)
+static bool montarLote(Conexao* c, size_t inicio, char lote[][TAM_LINHA], FILE* saida,
+                       size_t* fim_lote, int* num_linhas_lote) {
+    int num_linhas = 0;
+    bool excede_comandos = false, excede_linha = false;
+    size_t pos = inicio, consumido;
+    bool longa;
+    char linha[TAM_LINHA];
+
+    while (true) {
+        if (!proximaLinha(c, pos, linha, &consumido, &longa)) return false;
+        pos += consumido;
+        if (longa) {
+            excede_linha = true;
+        } else if (strcmp(linha, "FIM") == 0) {
+            break;
+        } else if (num_linhas < MAX_LOTE) {
+            strcpy(lote[num_linhas++], linha);
+        } else {
+            excede_comandos = true;
+        }
+    }
+
+    *num_linhas_lote = num_linhas;
+    if (excede_linha) {
+        fprintf(saida, "Lote tem linha com mais de %d caracteres. Nada foi aplicado.\n", TAM_LINHA - 1);
+        *num_linhas_lote = -1;
+    } else if (excede_comandos) {
+        fprintf(saida, "Lote excede o limite de %d comandos. Nada foi aplicado.\n", MAX_LOTE);
+        *num_linhas_lote = -1;
+    }
+    *fim_lote = pos;
+    return true;
+}
+
+// Cria um pedido de escrita com uma cópia dos comandos do lote
+static PedidoEscrita* criarPedido(Conexao* c, char lote[][TAM_LINHA], int num_linhas) {
+    PedidoEscrita* p = (PedidoEscrita*)malloc(sizeof(PedidoEscrita));
+    char (*linhas)[TAM_LINHA] = malloc((size_t)(num_linhas > 0 ? num_linhas : 1) * sizeof(*linhas));
+    if (p == NULL || linhas == NULL) {
+        printf("Erro de alocacao de memoria para pedido de escrita.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(linhas, lote, (size_t)num_linhas * sizeof(*linhas));
+    p->conexao = c;
+    p->linhas = linhas;
+    p->num_linhas = num_linhas;
+    p->prox = NULL;
+    return p;
+}
+
+// Executa os comandos completos que já estão no buffer da conexão, até a primeira escrita
+// As respostas são acumuladas em 'saida'; o que sobrar fica no buffer. Se encontrar uma
+// escrita, para e a devolve como pedido para a thread escritora (senão devolve NULL).
+static PedidoEscrita* processarBuffer(Conexao* c, int slot, char lote[][TAM_LINHA], FILE* saida) {
+    size_t inicio = 0, consumido;
+    bool longa;
+    char linha[TAM_LINHA];
+    PedidoEscrita* pedido = NULL;
+
+    while (true) {
+        if (c->descartando) {
+            // Ignora o resto de uma linha longa demais até o próximo '\n'
+            char* fim = memchr(c->buffer + inicio, '\n', c->usado - inicio);
+            if (fim == NULL) {
+                inicio = c->usado;
+                break;
+            }
+            inicio = (size_t)(fim - c->buffer) + 1;
+            c->descartando = false;
+        }
+
+        if (!proximaLinha(c, inicio, linha, &consumido, &longa)) {
+            if (c->usado - inicio >= TAM_LINHA) {
+                // Linha ainda sem fim e já longa demais: responde agora e descarta o resto
+                fprintf(saida, "Linha com mais de %d caracteres. Comando ignorado.\nFIM\n", TAM_LINHA - 1);
+                c->descartando = true;
+                inicio = c->usado;
+            }
+            break;
+        }
+
+        if (longa) {
+            fprintf(saida, "Linha com mais de %d caracteres. Comando ignorado.\n", TAM_LINHA - 1);
+            inicio += consumido;
+        } else if (strcmp(linha, "LOTE") == 0) {
+            size_t fim_lote;
+            int num_linhas;
+            if (!montarLote(c, inicio + consumido, lote, saida, &fim_lote, &num_linhas)) break; // Espera o FIM
+            inicio = fim_lote;
+            if (num_linhas >= 0) {
+                pedido = criarPedido(c, lote, num_linhas);
+                break; // O escritor responde (e escreve o FIM)
+            }
+        } else if (operacoes->ehComandoEscrita(linha)) {
+            strcpy(lote[0], linha);
+            pedido = criarPedido(c, lote, 1);
+            inicio += consumido;
+            break;
+        } else {
+            Versao* v = adquirirVersao(slot);
+            operacoes->executarConsulta(v->grafo, v->numero, linha, saida);
+            soltarVersao(slot);
+            inicio += consumido;
+        }
+        fprintf(saida, "FIM\n");
+    }
+
+    // Move o que não foi processado para o início do buffer
+    memmove(c->buffer, c->buffer + inicio, c->usado - inicio);
+    c->usado -= inicio;
+    return pedido;
+}
+
+// O que fazer com a conexão depois que um trabalhador a atendeu
+#define CONEXAO_DEVOLVER 0  // Volta para o poll
+#define CONEXAO_FECHAR 1    // Cliente saiu ou errou o protocolo
+#define CONEXAO_ESCRITOR 2  // Ficou com a thread escritora
+
+// Lê o que chegou na conexão e responde os comandos completos até a primeira escrita
+static int atenderConexao(Conexao* c, int slot, char lote[][TAM_LINHA]) {
+    if (c->retomar) {
+        c->retomar = false; // Os dados já estão no buffer; ler agora poderia bloquear
+    } else {
+        ssize_t lidos;
+        do {
+            lidos = read(c->fd, c->buffer + c->usado, TAM_BUFFER - c->usado);
+        } while (lidos < 0 && errno == EINTR);
+        if (lidos <= 0) return CONEXAO_FECHAR; // Cliente desconectou
+        c->usado += (size_t)lidos;
+    }
+
+    char* resposta = NULL;
+    size_t tamanho = 0;
+    FILE* saida = open_memstream(&resposta, &tamanho);
+    if (saida == NULL) return CONEXAO_FECHAR;
+
+    PedidoEscrita* pedido = processarBuffer(c, slot, lote, saida);
+    int destino = CONEXAO_DEVOLVER;
+    if (pedido == NULL && c->usado == TAM_BUFFER) {
+        // Só um LOTE sem FIM enche o buffer: não há como aceitá-lo
+        fprintf(saida, "Lote maior que %d bytes. Conexao encerrada.\nFIM\n", TAM_BUFFER);
+        destino = CONEXAO_FECHAR;
+    }
+
+    fclose(saida);
+    if (!enviarTudo(c->fd, resposta, tamanho)) destino = CONEXAO_FECHAR;
+    free(resposta);
+
+    if (pedido != NULL) {
+        if (destino == CONEXAO_FECHAR) {
+            free(pedido->linhas);
+            free(pedido);
+        } else {
+            // Entrega a escrita ao escritor e volta a atender outras conexões
+            pthread_mutex_lock(&mutex_pedidos);
+            if (pedidos_fim == NULL) {
+                pedidos_inicio = pedido;
+            } else {
+                pedidos_fim->prox = pedido;
+            }
+            pedidos_fim = pedido;
+            pthread_cond_signal(&tem_pedido);
+            pthread_mutex_unlock(&mutex_pedidos);
+            destino = CONEXAO_ESCRITOR;
+        }
+    }
+    return destino;
+}
+
+// Laço de cada trabalhador: pega uma conexão com dados, atende e devolve ao poll
+static void* trabalhador(void* arg) {
+    int slot = (int)(intptr_t)arg;
+    char (*lote)[TAM_LINHA] = malloc(MAX_LOTE * sizeof(*lote)); // Comandos do lote em montagem
+    if (lote == NULL) {
+        printf("Erro de alocacao de memoria para o lote do trabalhador %d.\n", slot);
+        exit(EXIT_FAILURE);
+    }
+
+    while (true) {
+        pthread_mutex_lock(&mutex_filas);
+        while (prontas_inicio == NULL) {
+            pthread_cond_wait(&tem_conexao_pronta, &mutex_filas);
+        }
+        Conexao* c = prontas_inicio;
+        prontas_inicio = c->prox;
+        if (prontas_inicio == NULL) prontas_fim = NULL;
+        pthread_mutex_unlock(&mutex_filas);
+
+        int destino = atenderConexao(c, slot, lote);
+        if (destino == CONEXAO_DEVOLVER) {
+            devolverConexao(c);
+        } else if (destino == CONEXAO_FECHAR) {
+            fecharConexao(c);
+        }
+    }
+    return NULL;
+}
+
+// Laço da thread escritora: a única que copia o grafo, aplica escritas e publica versões
+// Junta todos os pedidos que estiverem na fila em uma única versão nova; cada LOTE continua
+// sendo publicado de uma vez, porque nunca é dividido entre versões.
+static void* escritor(void* arg) {
+    (void)arg;
+    while (true) {
+        pthread_mutex_lock(&mutex_pedidos);
+        while (pedidos_inicio == NULL) {
+            pthread_cond_wait(&tem_pedido, &mutex_pedidos);
+        }
+        PedidoEscrita* pedidos = pedidos_inicio;
+        pedidos_inicio = NULL;
+        pedidos_fim = NULL;
+        pthread_mutex_unlock(&mutex_pedidos);
+
+        Versao* nova = (Versao*)malloc(sizeof(Versao));
+        if (nova == NULL) {
+            printf("Erro de alocacao de memoria para nova versao.\n");
+            exit(EXIT_FAILURE);
+        }
+        Versao* atual = atomic_load(&versao_atual);
+        nova->grafo = operacoes->copiarGrafo(atual->grafo);
+        nova->numero = atual->numero + 1;
+        nova->prox_retirada = NULL;
+
+        // Aplica os pedidos na ordem de chegada, guardando a resposta de cada um
+        // e se algum comando dele mudou o grafo
+        int num_pedidos = 0;
+        for (PedidoEscrita* p = pedidos; p != NULL; p = p->prox) num_pedidos++;
+        char** respostas = (char**)calloc((size_t)num_pedidos, sizeof(char*));
+        size_t* tamanhos = (size_t*)calloc((size_t)num_pedidos, sizeof(size_t));
+        FILE** saidas = (FILE**)calloc((size_t)num_pedidos, sizeof(FILE*));
+        bool* alterou = (bool*)calloc((size_t)num_pedidos, sizeof(bool));
+        if (respostas == NULL || tamanhos == NULL || saidas == NULL || alterou == NULL) {
+            printf("Erro de alocacao de memoria para as respostas do escritor.\n");
+            exit(EXIT_FAILURE);
+        }
+        int k = 0;
+        bool alguma_alteracao = false;
+        for (PedidoEscrita* p = pedidos; p != NULL; p = p->prox, k++) {
+            saidas[k] = open_memstream(&respostas[k], &tamanhos[k]);
+            FILE* saida = (saidas[k] != NULL) ? saidas[k] : stderr;
+            for (int i = 0; i < p->num_linhas; i++) {
+                if (operacoes->executarEscrita(nova->grafo, p->linhas[i], saida)) alterou[k] = true;
+            }
+            if (alterou[k]) alguma_alteracao = true;
+        }
+
+        // Só publica se algo mudou; senão a cópia é descartada e a versão atual continua
+        unsigned long numero;
+        if (alguma_alteracao) {
+            numero = nova->numero;
+            publicarVersao(nova);
+        } else {
+            numero = atual->numero; // Só o escritor publica, então 'atual' continua válida
+            operacoes->liberarGrafo(nova->grafo);
+            free(nova);
+        }
+
+        // Responde cada cliente e devolve a conexão aos trabalhadores, que seguem com o
+        // resto do buffer dela (comandos enviados depois desta escrita)
+        k = 0;
+        while (pedidos != NULL) {
+            PedidoEscrita* p = pedidos;
+            pedidos = p->prox;
+            bool enviado = false;
+            if (saidas[k] != NULL) {
+                if (alterou[k]) {
+                    fprintf(saidas[k], "Versao %lu publicada.\nFIM\n", numero);
+                } else {
+                    fprintf(saidas[k], "Nenhuma alteracao; versao atual: %lu.\nFIM\n", numero);
+                }
+                fclose(saidas[k]);
+                enviado = enviarTudo(p->conexao->fd, respostas[k], tamanhos[k]);
+                free(respostas[k]);
+            }
+            if (enviado) {
+                p->conexao->retomar = true;
+                enfileirarConexao(p->conexao);
+            } else {
+                fecharConexao(p->conexao);
+            }
+            free(p->linhas);
+            free(p);
+            k++;
+        }
+        free(respostas);
+        free(tamanhos);
+        free(saidas);
+        free(alterou);
+    }
+    return NULL;
+}
+
+// Aceita um novo cliente; retorna a conexão ou NULL se ela foi recusada
+static Conexao* aceitarConexao(void) {
+    int fd = accept(socket_servidor, NULL, NULL);
+    if (fd < 0) {
+        if (errno != EINTR) perror("accept");
+        return NULL;
+    }
+    if (atomic_load(&num_conexoes) >= MAX_CONEXOES) {
+        const char* aviso = "Servidor cheio. Tente novamente mais tarde.\nFIM\n";
+        enviarTudo(fd, aviso, strlen(aviso));
+        close(fd);
+        return NULL;
+    }
+
+    Conexao* c = (Conexao*)malloc(sizeof(Conexao));
+    char* buffer = (char*)malloc(TAM_BUFFER);
+    if (c == NULL || buffer == NULL) {
+        free(c);
+        free(buffer);
+        close(fd);
+        return NULL;
+    }
+    c->fd = fd;
+    c->buffer = buffer;
+    c->usado = 0;
+    c->descartando = false;
+    c->retomar = false;
+    c->prox = NULL;
+    atomic_fetch_add(&num_conexoes, 1);
+    return c;
+}
+
+// Laço do poll: espera dados nas conexões ociosas e entrega as prontas aos trabalhadores
+static void esperarConexoes(void) {
+    // Posição 0: socket do servidor; posição 1: pipe de despertar; demais: conexões ociosas
+    static struct pollfd fds[MAX_CONEXOES + 2];
+    static Conexao* conexoes[MAX_CONEXOES + 2];
+    int num_fds = 2;
+    fds[0].fd = socket_servidor;
+    fds[0].events = POLLIN;
+    fds[1].fd = pipe_despertar[0];
+    fds[1].events = POLLIN;
+
+    while (true) {
+        if (poll(fds, (nfds_t)num_fds, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            return;
+        }
+
+        // Conexões com dados (ou fechadas) saem do poll e vão para os trabalhadores
+        for (int i = num_fds - 1; i >= 2; i--) {
+            if (fds[i].revents != 0) {
+                enfileirarConexao(conexoes[i]);
+                fds[i] = fds[num_fds - 1];
+                conexoes[i] = conexoes[num_fds - 1];
+                num_fds--;
+            }
+        }
+
+        // Conexões devolvidas pelos trabalhadores voltam para o poll
+        if (fds[1].revents & POLLIN) {
+            char sinais[64];
+            if (read(pipe_despertar[0], sinais, sizeof(sinais)) < 0 && errno != EINTR) {
+                perror("read");
+            }
+            pthread_mutex_lock(&mutex_filas);
+            Conexao* c = devolvidas;
+            devolvidas = NULL;
+            pthread_mutex_unlock(&mutex_filas);
+            while (c != NULL) {
+                Conexao* prox = c->prox;
+                fds[num_fds].fd = c->fd;
+                fds[num_fds].events = POLLIN;
+                fds[num_fds].revents = 0;
+                conexoes[num_fds++] = c;
+                c = prox;
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            Conexao* c = aceitarConexao();
+            if (c != NULL) {
+                fds[num_fds].fd = c->fd;
+                fds[num_fds].events = POLLIN;
+                fds[num_fds].revents = 0;
+                conexoes[num_fds++] = c;
+            }
+        }
+    }
+}
+
+// Inicia o servidor no socket local 'caminho' com 'num_trabalhadores' threads
+int iniciarServidor(const char* caminho, int num_trabalhadores, const OperacoesGrafo* ops) {
+    if (num_trabalhadores < 1) num_trabalhadores = 1;
+    if (num_trabalhadores > MAX_TRABALHADORES) num_trabalhadores = MAX_TRABALHADORES;
+
+    struct sockaddr_un endereco;
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        printf("Caminho do socket muito longo.\n");
+        return EXIT_FAILURE;
+    }
+
+    // A versão 0 é o grafo vazio
+    operacoes = ops;
+    Versao* inicial = (Versao*)malloc(sizeof(Versao));
+    if (inicial == NULL) {
+        printf("Erro de alocacao de memoria para a versao inicial.\n");
+        return EXIT_FAILURE;
+    }
+    inicial->grafo = operacoes->criarGrafoVazio();
+    inicial->numero = 0;
+    inicial->prox_retirada = NULL;
+    atomic_store(&versao_atual, inicial);
+    for (int i = 0; i < MAX_TRABALHADORES; i++) {
+        atomic_store(&versao_em_uso[i], NULL);
+    }
+
+    signal(SIGPIPE, SIG_IGN); // Um cliente que some não deve derrubar o servidor
+
+    if (pipe(pipe_despertar) < 0) {
+        perror("pipe");
+        return EXIT_FAILURE;
+    }
+    socket_servidor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket_servidor < 0) {
+        perror("socket");
+        return EXIT_FAILURE;
+    }
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strcpy(endereco.sun_path, caminho);
+    unlink(caminho); // Remove um socket deixado por uma execução anterior
+    if (bind(socket_servidor, (struct sockaddr*)&endereco, sizeof(endereco)) < 0 ||
+        listen(socket_servidor, 128) < 0) {
+        perror("bind/listen");
+        close(socket_servidor);
+        return EXIT_FAILURE;
+    }
+
+    pthread_t thread;
+    int erro_escritor = pthread_create(&thread, NULL, escritor, NULL);
+    if (erro_escritor != 0) {
+        printf("Nao foi possivel criar a thread escritora: %s\n", strerror(erro_escritor));
+        close(socket_servidor);
+        unlink(caminho);
+        return EXIT_FAILURE;
+    }
+    pthread_detach(thread);
+    for (int i = 0; i < num_trabalhadores; i++) {
+        int erro = pthread_create(&thread, NULL, trabalhador, (void*)(intptr_t)i);
+        if (erro != 0) {
+            printf("Nao foi possivel criar o trabalhador %d: %s\n", i, strerror(erro));
+            close(socket_servidor);
+            unlink(caminho);
+            return EXIT_FAILURE;
+        }
+        pthread_detach(thread); // Os trabalhadores vivem até o fim do processo
+    }
+    printf("Servidor %s ouvindo em '%s' com %d trabalhadores (ate %d conexoes).\n",
+           operacoes->descricao, caminho, num_trabalhadores, MAX_CONEXOES);
+    fflush(stdout);
+
+    esperarConexoes(); // Só retorna se o poll falhar
+    close(socket_servidor);
+    unlink(caminho);
+    return EXIT_FAILURE;
+}
+
+// Gerador de Carga (cliente de teste do modo servidor)
+
+// Parâmetros e resultados de uma thread do gerador de carga
+typedef struct ClienteCarga {
+    const char* caminho;   // Socket do servidor
+    int requisicoes;       // Quantas consultas esta thread deve enviar
+    unsigned int semente;  // Semente do gerador aleatório da thread
+    long concluidas;       // Quantas respostas foram recebidas
+} ClienteCarga;
+
+static atomic_bool carga_terminou = false; // Avisa o escritor de carga que as leituras acabaram
+
+// Conecta ao servidor e devolve o socket, ou -1 em caso de erro
+static int conectarServidor(const char* caminho) {
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strncpy(endereco.sun_path, caminho, sizeof(endereco.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&endereco, sizeof(endereco)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Abre o socket como dois FILE (leitura e escrita); retorna false e fecha tudo em caso de erro
+static bool abrirFluxos(int fd, FILE** entrada, FILE** saida) {
+    *entrada = fdopen(fd, "r");
+    if (*entrada == NULL) {
+        close(fd);
+        return false;
+    }
+    int copia = dup(fd);
+    *saida = (copia < 0) ? NULL : fdopen(copia, "w");
+    if (*saida == NULL) {
+        if (copia >= 0) close(copia);
+        fclose(*entrada);
+        return false;
+    }
+    return true;
+}
+
+// Lê e descarta uma resposta do servidor (até a linha FIM)
+static bool lerResposta(FILE* entrada) {
+    char linha[TAM_LINHA];
+    while (fgets(linha, TAM_LINHA, entrada) != NULL) {
+        if (strcmp(linha, "FIM\n") == 0) return true;
+    }
+    return false;
+}
+
+// Thread leitora: envia consultas aleatórias e espera cada resposta
+static void* clienteLeitor(void* arg) {
+    ClienteCarga* c = (ClienteCarga*)arg;
+    int fd = conectarServidor(c->caminho);
+    FILE* entrada;
+    FILE* saida;
+    if (fd < 0 || !abrirFluxos(fd, &entrada, &saida)) return NULL;
+
+    for (int i = 0; i < c->requisicoes; i++) {
+        operacoes->escreverConsulta(saida, &c->semente);
+        fflush(saida);
+        if (!lerResposta(entrada)) break;
+        c->concluidas++;
+    }
+
+    fclose(saida);
+    fclose(entrada);
+    return NULL;
+}
+
+// Thread escritora: envia pequenos lotes enquanto as leituras acontecem
+static void* clienteEscritor(void* arg) {
+    ClienteCarga* c = (ClienteCarga*)arg;
+    int fd = conectarServidor(c->caminho);
+    FILE* entrada;
+    FILE* saida;
+    if (fd < 0 || !abrirFluxos(fd, &entrada, &saida)) return NULL;
+    struct timespec pausa = { 0, 10 * 1000 * 1000 }; // 10 ms entre lotes
+
+    while (!atomic_load(&carga_terminou)) {
+        fprintf(saida, "LOTE\n");
+        operacoes->escreverLoteCarga(saida, &c->semente);
+        fprintf(saida, "FIM\n");
+        fflush(saida);
+        if (!lerResposta(entrada)) break;
+        c->concluidas++;
+        nanosleep(&pausa, NULL);
+    }
+
+    fclose(saida);
+    fclose(entrada);
+    return NULL;
+}
+
+// Popula o servidor e mede a vazão de consultas concorrentes
+int gerarCarga(const char* caminho, int num_threads, int requisicoes, const OperacoesGrafo* ops) {
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > MAX_TRABALHADORES) num_threads = MAX_TRABALHADORES;
+    operacoes = ops;
+
+    int fd = conectarServidor(caminho);
+    if (fd < 0) {
+        printf("Nao foi possivel conectar ao servidor em '%s'.\n", caminho);
+        return EXIT_FAILURE;
+    }
+    FILE* entrada;
+    FILE* saida;
+    if (!abrirFluxos(fd, &entrada, &saida)) {
+        printf("Erro ao abrir a conexao com o servidor.\n");
+        return EXIT_FAILURE;
+    }
+    unsigned int semente = 42;
+    fprintf(saida, "LOTE\n");
+    operacoes->escreverPopulacao(saida, &semente);
+    fprintf(saida, "FIM\n");
+    fflush(saida);
+    bool populado = lerResposta(entrada);
+    fclose(saida);
+    fclose(entrada);
+    if (!populado) {
+        printf("O servidor nao respondeu ao lote inicial.\n");
+        return EXIT_FAILURE;
+    }
+
+    ClienteCarga leitores[MAX_TRABALHADORES];
+    pthread_t threads[MAX_TRABALHADORES];
+    ClienteCarga escritor = { caminho, 0, 7u, 0 };
+    pthread_t thread_escritor;
+    struct timespec inicio, fim;
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    int erro = pthread_create(&thread_escritor, NULL, clienteEscritor, &escritor);
+    if (erro != 0) {
+        printf("Nao foi possivel criar a thread escritora: %s\n", strerror(erro));
+        return EXIT_FAILURE;
+    }
+    int criadas = 0;
+    for (int i = 0; i < num_threads; i++) {
+        leitores[i] = (ClienteCarga){ caminho, requisicoes, (unsigned int)(i + 1), 0 };
+        erro = pthread_create(&threads[i], NULL, clienteLeitor, &leitores[i]);
+        if (erro != 0) {
+            printf("Nao foi possivel criar a thread leitora %d: %s\n", i, strerror(erro));
+            break;
+        }
+        criadas++;
+    }
+
+    long total = 0;
+    for (int i = 0; i < criadas; i++) {
+        pthread_join(threads[i], NULL);
+        total += leitores[i].concluidas;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    atomic_store(&carga_terminou, true);
+    pthread_join(thread_escritor, NULL);
+
+    double segundos = (double)(fim.tv_sec - inicio.tv_sec) + (double)(fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    printf("Consultas: %ld em %.3f s (%.0f consultas/s) com %d threads; lotes enviados durante o teste: %ld\n",
+           total, segundos, segundos > 0 ? (double)total / segundos : 0.0, criadas, escritor.concluidas);
+    return (criadas == num_threads && total == (long)num_threads * requisicoes) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#else
+
+// Sockets locais e pthreads não estão disponíveis: o modo servidor fica desativado
+
+int iniciarServidor(const char* caminho, int num_trabalhadores, const OperacoesGrafo* ops) {
+    (void)caminho; (void)num_trabalhadores; (void)ops;
+    printf("O modo servidor so esta disponivel em sistemas POSIX.\n");
+    return EXIT_FAILURE;
+}
+
+int gerarCarga(const char* caminho, int num_threads, int requisicoes, const OperacoesGrafo* ops) {
+    (void)caminho; (void)num_threads; (void)requisicoes; (void)ops;
+    printf("O modo servidor so esta disponivel em sistemas POSIX.\n");
+    return EXIT_FAILURE;
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+// Modo Servidor Concorrente (compartilhado pelos dois exercícios)
+//
+// Uma thread espera (poll) dados de todos os clientes conectados por um socket local
+// e entrega cada conexão pronta a um conjunto fixo de trabalhadores, que respondem os
+// comandos recebidos e devolvem a conexão. Clientes parados não ocupam trabalhadores. As
+// consultas leem uma versão imutável do grafo. Ao encontrar uma escrita, o trabalhador só
+// a coloca na fila da thread escritora e segue para outra conexão; o escritor aplica as
+// escritas em uma cópia, publica a cópia com uma troca atômica de ponteiro, responde o
+// cliente e devolve a conexão aos trabalhadores. Assim uma leitura nunca espera por uma
+// escrita, e os comandos de cada cliente continuam sendo respondidos na ordem enviada.
+//
+// Este módulo não conhece o grafo: cada exercício informa, por meio de OperacoesGrafo,
+// como copiar, liberar, escrever e consultar o seu grafo.
+//
+// Protocolo (uma linha por comando, cada resposta termina com a linha "FIM"):
+//   <consulta>                      executada sobre a versão publicada atual
+//   <escrita>                       vira um lote de um único comando
+//   LOTE, seguido de escritas, terminado por FIM  (publicado em uma única versão)
+// Cada comando é "NOME argumentos"; vários argumentos são separados por ';', então
+// nomes podem ter espaços (ex.: "CONEXAO Ana Maria;Joao"), mas não ';'.
+// Linhas com mais de TAM_LINHA - 1 caracteres são recusadas inteiras.
+
+#include <stdio.h>    // Para FILE
+#include <stdbool.h>  // Para usar tipos booleanos (true/false)
+#include <stddef.h>   // Para size_t
+
+#define MAX_TRABALHADORES 64    // Número máximo de threads de consulta no modo servidor
+#define TAM_LINHA 256           // Tamanho máximo de uma linha do protocolo do servidor
+#define MAX_LOTE 512            // Número máximo de comandos de escrita em um lote
+#define MAX_CONEXOES 1024       // Número máximo de clientes conectados ao mesmo tempo
+
+// Funções que cada exercício fornece para o servidor e o gerador de carga
+typedef struct OperacoesGrafo {
+    const char* descricao; // Nome do serviço, usado nas mensagens
+
+    // Servidor
+    void* (*criarGrafoVazio)(void);              // Grafo da versão 0
+    void* (*copiarGrafo)(void* grafo);           // Cópia independente de um grafo
+    void (*liberarGrafo)(void* grafo);           // Libera um grafo criado pelas funções acima
+    bool (*ehComandoEscrita)(const char* linha); // Diz se a linha altera o grafo
+    bool (*executarEscrita)(void* grafo, const char* linha, FILE* saida); // Retorna true se o grafo mudou
+    void (*executarConsulta)(void* grafo, unsigned long versao, const char* linha, FILE* saida);
+
+    // Gerador de carga (cada função escreve linhas do protocolo em 'saida')
+    void (*escreverPopulacao)(FILE* saida, unsigned int* semente);  // Escritas do lote inicial
+    void (*escreverConsulta)(FILE* saida, unsigned int* semente);   // Uma consulta aleatória
+    void (*escreverLoteCarga)(FILE* saida, unsigned int* semente);  // Escritas de um lote durante o teste
+} OperacoesGrafo;
+
+// Devolve os argumentos de 'linha' se ela for o comando 'comando' seguido de espaço, ou NULL
+const char* argumentosDoComando(const char* linha, const char* comando);
+
+// Separa 'argumentos' em exatamente 'num_campos' campos divididos por ';', sem os espaços
+// das pontas, copiando cada um para 'campos[i]' (com 'tam_campo' bytes cada)
+// Retorna false se o número de campos for outro ou se algum for vazio ou longo demais
+bool separarCampos(const char* argumentos, char* campos[], int num_campos, size_t tam_campo);
+
+// Inicia o servidor no socket local 'caminho' com 'num_trabalhadores' threads
+int iniciarServidor(const char* caminho, int num_trabalhadores, const OperacoesGrafo* ops);
+
+// Sorteia um número em [0, limite) usando a semente de uma thread do gerador de carga
+int sortearNumero(unsigned int* semente, int limite);
+
+// Mede a vazão de um servidor já iniciado com 'num_threads' clientes leitores
+int gerarCarga(const char* caminho, int num_threads, int requisicoes, const OperacoesGrafo* ops);
+
+#endif